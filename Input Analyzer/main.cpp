@@ -0,0 +1,130 @@
+#include "cl_InputAnalyzer.h"
+#include <Windows.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+
+//Command-line front end for InputAnalyzer.
+//usage: "Input Analyzer" [--threads N] [--frame-ms MS] <recording or directory>...
+//Every file in a directory is treated as a recording (directories aren't searched recursively).
+
+namespace {
+  //the frame period main.cpp's pacer runs at
+  constexpr double DEFAULT_FRAME_MS = 16.667;
+
+  void addPaths(const std::string& arg, std::vector<std::string>& paths) {
+    DWORD attributes = GetFileAttributesA(arg.c_str());
+    if(attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      paths.push_back(arg);
+      return;
+    }
+
+    WIN32_FIND_DATAA found;
+    HANDLE search = FindFirstFileA((arg + "\\*").c_str(), &found);
+    if(search == INVALID_HANDLE_VALUE) { return; }
+    do {
+      if(!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) { paths.push_back(arg + "\\" + found.cFileName); }
+    } while(FindNextFileA(search, &found));
+    FindClose(search);
+  }
+
+  std::string controlName(size_t bit) {
+    std::stringstream ss;
+    if(bit < InputFrame::MOUSE_BUTTON_OFFSET) { ss << "key 0x" << std::hex << std::setw(2) << std::setfill('0') << bit; }
+    else if(bit < InputFrame::GAMEPAD_BUTTON_OFFSET) { ss << "mouse " << bit - InputFrame::MOUSE_BUTTON_OFFSET; }
+    else { ss << "pad " << bit - InputFrame::GAMEPAD_BUTTON_OFFSET; }
+    return ss.str();
+  }
+
+  //one line per non-empty bucket (see InputTelemetry::bucket())
+  void printHistogram(const char* title, const InputAnalyzer::Histogram& histogram) {
+    std::cout << "  " << title << ":\n";
+    for(size_t b = 0; b < histogram.size(); b++) {
+      if(histogram[b] == 0) { continue; }
+      std::stringstream range;
+      if(b == 0) { range << "<1ms"; }
+      else if(b == histogram.size() - 1) { range << ">=" << (1u << (b - 1)) << "ms"; }
+      else { range << (1u << (b - 1)) << "-" << (1u << b) << "ms"; }
+      std::cout << "    " << std::setw(10) << range.str() << " " << histogram[b] << "\n";
+    }
+  }
+
+  void printDevice(const char* name, const InputAnalyzer::Totals& totals, Input::DeviceType type, size_t firstBit, size_t bitCt) {
+    InputAnalyzer::ControlTotals sum = { 0, InputAnalyzer::Histogram{}, InputAnalyzer::Histogram{}, 0 };
+    for(size_t bit = firstBit; bit < firstBit + bitCt; bit++) {
+      auto& control = totals.controls[bit];
+      sum.presses += control.presses;
+      sum.repeats += control.repeats;
+      for(size_t b = 0; b < sum.holdDurations.size(); b++) {
+        sum.holdDurations[b] += control.holdDurations[b];
+        sum.pressIntervals[b] += control.pressIntervals[b];
+      }
+    }
+
+    //recordings hold frame states rather than raw events, so activity is counted in edges and changed frames
+    uint64_t edges = totals.edges[static_cast<size_t>(type)];
+    uint64_t activeFrames = totals.activeFrames[static_cast<size_t>(type)];
+    std::cout << name << ": " << edges << " edges (" << (totals.seconds > 0 ? edges / totals.seconds : 0) << "/s), ";
+    std::cout << "changed in " << activeFrames << " frames (" << (totals.frames > 0 ? 100.0 * activeFrames / totals.frames : 0) << "%), ";
+    std::cout << sum.presses << " presses, " << sum.repeats << " repeats\n";
+    printHistogram("hold durations", sum.holdDurations);
+    printHistogram("press intervals", sum.pressIntervals);
+  }
+}
+
+int main(int argc, char** argv) {
+  unsigned int threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+  double frameMS = DEFAULT_FRAME_MS;
+  std::vector<std::string> paths;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "--threads") && i + 1 < argc) { threadCount = static_cast<unsigned int>(std::atoi(argv[++i])); }
+    else if(!strcmp(argv[i], "--frame-ms") && i + 1 < argc) { frameMS = std::atof(argv[++i]); }
+    else { addPaths(argv[i], paths); }
+  }
+
+  if(paths.empty()) {
+    std::cerr << "usage: " << argv[0] << " [--threads N] [--frame-ms MS] <recording or directory>...\n";
+    return 2;
+  }
+
+  try {
+    InputAnalyzer analyzer(frameMS);
+    auto start = std::chrono::steady_clock::now();
+    InputAnalyzer::Totals totals = analyzer.analyzeFiles(paths, threadCount);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << totals.sessions << " sessions, " << totals.frames << " frames, " << totals.seconds << "s of input (analyzed in " << elapsed << "s)\n";
+    printDevice("keyboard", totals, Input::DeviceType::KEYBOARD, InputFrame::KEYBOARD_BUTTON_OFFSET, InputFrame::KEYBOARD_BUTTON_CT);
+    printDevice("mouse",    totals, Input::DeviceType::MOUSE,    InputFrame::MOUSE_BUTTON_OFFSET,    InputFrame::MOUSE_BUTTON_CT);
+    printDevice("gamepad",  totals, Input::DeviceType::GAMEPAD,  InputFrame::GAMEPAD_BUTTON_OFFSET,  InputFrame::GAMEPAD_BUTTON_CT);
+
+    //the most pressed controls
+    constexpr size_t TOP_CT = 10;
+    std::vector<size_t> bits;
+    for(size_t bit = 0; bit < totals.controls.size(); bit++) {
+      if(totals.controls[bit].presses) { bits.push_back(bit); }
+    }
+    std::sort(bits.begin(), bits.end(), [&totals](size_t a, size_t b) { return totals.controls[a].presses > totals.controls[b].presses; });
+    std::cout << "most pressed:\n";
+    for(size_t i = 0; i < (std::min)(TOP_CT, bits.size()); i++) {
+      auto& control = totals.controls[bits[i]];
+      std::cout << "  " << std::setw(10) << controlName(bits[i]) << " " << control.presses << " presses, " << control.repeats << " repeats\n";
+    }
+
+    for(auto& failure : totals.failures) { std::cerr << "failed: " << failure << "\n"; }
+    return totals.failures.empty() ? 0 : 1;
+  }
+  catch(const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 2;
+  }
+}
@@ -0,0 +1,85 @@
+#include "ns_Bench.h"
+#include "cl_Input.h"
+#include "ns_Utility.h"
+#include <Xinput.h>
+
+//Device decoding through a headless Input, so the event queues and update() are part of what is measured.
+//The mouse cases are per event at a thousand events a frame, which is mostly the per-event decoding. The
+//gamepad cases are per frame with one injected pad state each, so they include a whole (otherwise idle)
+//update(), so compare them with idleUpdatePerFrame.
+namespace {
+  const HANDLE BENCH_MOUSE = reinterpret_cast<HANDLE>(0xBE4C0001);
+  constexpr int MOUSE_FRAMES = 2000;
+  constexpr int EVENTS_PER_FRAME = 1000;
+  constexpr int PAD_FRAMES = 200000;
+  constexpr uint64_t FRAME_NS = 16 * Utility::NS_PER_MS;
+
+  double mouseEvents(USHORT (*buttonFlags)(int event)) {
+    Input input;
+    uint64_t timeNS = Utility::NS_PER_SECOND;
+    RAWINPUT event = {};
+    event.header.dwType = RIM_TYPEMOUSE;
+    event.header.hDevice = BENCH_MOUSE;
+
+    uint64_t start = Utility::nowNS();
+    for(int frame = 0; frame < MOUSE_FRAMES; frame++) {
+      for(int i = 0; i < EVENTS_PER_FRAME; i++) {
+        event.data.mouse.lLastX = i & 7;
+        event.data.mouse.usButtonFlags = buttonFlags(i);
+        input.injectEvent(event);
+      }
+      input.update(timeNS += FRAME_NS);
+    }
+    double elapsed = static_cast<double>(Utility::nowNS() - start);
+
+    Bench::keep(static_cast<uint64_t>(input.mouse().axes[Input::Mouse::DELTA_X]));
+    return elapsed / (MOUSE_FRAMES * EVENTS_PER_FRAME);
+  }
+
+  double padFrames(WORD (*buttons)(int frame)) {
+    Input input;
+    uint64_t timeNS = Utility::NS_PER_SECOND;
+    XINPUT_GAMEPAD pad = {};
+    pad.sThumbLX = 12000;
+
+    uint64_t start = Utility::nowNS();
+    for(int frame = 0; frame < PAD_FRAMES; frame++) {
+      pad.wButtons = buttons(frame);
+      timeNS += FRAME_NS;
+      input.injectGamepadState(pad, timeNS);
+      input.update(timeNS);
+    }
+    double elapsed = static_cast<double>(Utility::nowNS() - start);
+
+    Bench::keep(input.gamepad().heldCount);
+    return elapsed / PAD_FRAMES;
+  }
+}
+
+BENCHMARK(idleUpdatePerFrame) {
+  Input input;
+  uint64_t timeNS = Utility::NS_PER_SECOND;
+
+  uint64_t start = Utility::nowNS();
+  for(int frame = 0; frame < PAD_FRAMES; frame++) { input.update(timeNS += FRAME_NS); }
+  double elapsed = static_cast<double>(Utility::nowNS() - start);
+
+  Bench::keep(input.frameNumber());
+  return elapsed / PAD_FRAMES;
+}
+
+BENCHMARK(mouseMotionOnlyPerEvent) {
+  return mouseEvents([](int) -> USHORT { return 0; });
+}
+
+BENCHMARK(mouseButtonPerEvent) {
+  return mouseEvents([](int event) -> USHORT { return (event & 1) ? RI_MOUSE_LEFT_BUTTON_UP : RI_MOUSE_LEFT_BUTTON_DOWN; });
+}
+
+BENCHMARK(gamepadUnchangedPerFrame) {
+  return padFrames([](int) -> WORD { return XINPUT_GAMEPAD_A; });
+}
+
+BENCHMARK(gamepadChangingPerFrame) {
+  return padFrames([](int frame) -> WORD { return (frame & 1) ? XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y : 0; });
+}
@@ -0,0 +1,63 @@
+#include "ns_Bench.h"
+#include "cl_VirtualControllers.h"
+#include "ns_Utility.h"
+
+//VirtualControllers::update() on one thread, per controller. Each case injects its events between updates
+//and only times the updates.
+namespace {
+  constexpr size_t CONTROLLER_CT = 10000;
+  constexpr size_t CHURN_CONTROLLER_CT = 100000;
+  constexpr int FRAMES = 1000;
+  constexpr int CHURN_FRAMES = 200;
+  constexpr uint64_t FRAME_NS = 16666666;
+
+  //'feed' injects one frame's events, and the rest of the frame is the timed update
+  template<typename Feed>
+  double perController(VirtualControllers& controllers, int frames, Feed feed) {
+    uint64_t timeNS = Utility::NS_PER_SECOND;
+    uint64_t total = 0;
+    for(int frame = 0; frame < frames; frame++) {
+      feed(frame);
+      timeNS += FRAME_NS;
+      uint64_t start = Utility::nowNS();
+      controllers.update(timeNS);
+      total += Utility::nowNS() - start;
+    }
+
+    Bench::keep(controllers.heldButtons(controllers.size() - 1));
+    return static_cast<double>(total) / frames / controllers.size();
+  }
+}
+
+BENCHMARK(virtualIdlePerController) {
+  VirtualControllers controllers(CONTROLLER_CT);
+  return perController(controllers, FRAMES, [&](int frame) {
+    for(size_t i = 0; i < CONTROLLER_CT; i += 10) { controllers.setAxis(i, Input::Gamepad::LEFT_X, frame * 0.001f); }
+  });
+}
+
+BENCHMARK(virtualTwoHeldPerController) {
+  VirtualControllers controllers(CONTROLLER_CT);
+  for(size_t i = 0; i < CONTROLLER_CT; i++) {
+    controllers.press(i, Input::Gamepad::START);
+    controllers.press(i, Input::Gamepad::A);
+  }
+  return perController(controllers, FRAMES, [&](int frame) {
+    for(size_t i = 0; i < CONTROLLER_CT; i += 10) { controllers.setAxis(i, Input::Gamepad::LEFT_X, frame * 0.001f); }
+  });
+}
+
+BENCHMARK(virtualChurnPerController) {
+  VirtualControllers controllers(CHURN_CONTROLLER_CT);
+  uint32_t rng = 1;
+  return perController(controllers, CHURN_FRAMES, [&](int) {
+    //about one controller in six presses or releases a random button each frame
+    for(size_t i = 0; i < CHURN_CONTROLLER_CT; i++) {
+      rng = rng * 1664525 + 1013904223;
+      if((rng >> 24) >= 40) { continue; }
+      size_t button = (rng >> 8) % VirtualControllers::BUTTON_CT;
+      if(rng & 1) { controllers.press(i, button); }
+      else { controllers.release(i, button); }
+    }
+  });
+}
@@ -0,0 +1,36 @@
+#include "ns_Bench.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+
+//Runs every registered benchmark, or only those whose names contain one of the arguments, and prints the
+//median of several runs of each.
+//usage: "Input Bench" [--runs N] [name filter]...
+namespace {
+  constexpr int DEFAULT_RUNS = 3;
+}
+
+int main(int argc, char** argv) {
+  int runs = DEFAULT_RUNS;
+  std::vector<const char*> filters;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "--runs") && i + 1 < argc) { runs = (std::max)(1, atoi(argv[++i])); }
+    else { filters.push_back(argv[i]); }
+  }
+
+  for(auto& bench : Bench::cases()) {
+    bool selected = filters.empty();
+    for(const char* filter : filters) { selected |= strstr(bench.name, filter) != nullptr; }
+    if(!selected) { continue; }
+
+    std::vector<double> results;
+    for(int i = 0; i < runs; i++) { results.push_back(bench.run()); }
+    std::sort(results.begin(), results.end());
+
+    std::cout << std::left << std::setw(36) << bench.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << results[results.size() / 2] << " ns\n";
+  }
+  return 0;
+}
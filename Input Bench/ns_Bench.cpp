@@ -0,0 +1,16 @@
+#include "ns_Bench.h"
+
+namespace {
+  volatile uint64_t sink;
+}
+
+std::vector<Bench::Case>& Bench::cases() {
+  //created by whichever BENCHMARK registers first - a global vector here might not be constructed yet
+  //when the registrars in bench_Devices.cpp run
+  static std::vector<Case> registered;
+  return registered;
+}
+
+void Bench::keep(uint64_t value) {
+  sink = value;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+//Minimal benchmark registry for the Input Bench runner (see main.cpp). A BENCHMARK registers itself before
+//main() runs and returns the nanoseconds it took per operation, where the operation is whatever its name
+//says (an event, a frame, a controller). The runner repeats each one and reports the median.
+//Build and run it in Release - the numbers from a Debug build mean nothing.
+namespace Bench {
+  struct Case {
+    const char* name;
+    double (*run)();
+  };
+  std::vector<Case>& cases();
+
+  struct Registrar {
+    Registrar(const char* name, double (*run)()) { cases().push_back(Case{ name, run }); }
+  };
+
+  //stores 'value' where the optimizer has to assume it is read, so the work that produced it stays in
+  void keep(uint64_t value);
+}
+
+#define BENCHMARK(name) \
+  static double name(); \
+  static Bench::Registrar name##Registrar(#name, name); \
+  static double name()
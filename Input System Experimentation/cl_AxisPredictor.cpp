@@ -0,0 +1,105 @@
+#include "cl_AxisPredictor.h"
+#include "ns_Utility.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+  //how many samples each estimate needs before it means anything
+  constexpr unsigned int VELOCITY_SAMPLES = 2;
+  constexpr unsigned int ACCELERATION_SAMPLES = 3;
+
+  //weight of each new sample in the running error
+  constexpr float ERROR_SMOOTHING = 0.125f;
+}
+
+AxisPredictor::AxisPredictor(Input& input) : input(input) {
+  frameSubscription = input.subscribeFrame([this]() { sample(); });
+}
+
+AxisPredictor::~AxisPredictor() {
+  input.unsubscribe(frameSubscription);
+}
+
+void AxisPredictor::configure(Input::DeviceType device, size_t axis, const AxisConfig& config) {
+  size_t index = Input::axisIndex(device, axis);
+  if(config.smoothing <= 0 || config.smoothing > 1) { throw std::runtime_error("Prediction smoothing must be in (0, 1]."); }
+
+  axes[index] = AxisState();
+  axes[index].config = config;
+
+  activeAxes.erase(std::remove(activeAxes.begin(), activeAxes.end(), index), activeAxes.end());
+  if(config.model != Model::NONE) { activeAxes.push_back(index); }
+}
+
+float AxisPredictor::predict(Input::DeviceType device, size_t axis, uint64_t timeNS) const {
+  size_t index = Input::axisIndex(device, axis);
+  const AxisState& axisState = axes[index];
+
+  float current = isMouseAxis(index) ? 0 : input.state(device).axes[axis];
+  if(axisState.config.model == Model::NONE || timeNS <= lastSampleNS) { return current; }
+
+  float horizonMS = static_cast<float>((timeNS - lastSampleNS) / 1e6);
+  horizonMS = (std::min)(horizonMS, axisState.config.maxHorizonMS);
+  float change = extrapolate(axisState, horizonMS / 1000);
+  if(isMouseAxis(index)) { return change; }
+
+  //the triggers only go from 0 to 1
+  bool trigger = axis == Input::Gamepad::LTRIGGER || axis == Input::Gamepad::RTRIGGER;
+  return (std::max)(trigger ? 0.0f : -1.0f, (std::min)(1.0f, current + change));
+}
+
+float AxisPredictor::error(Input::DeviceType device, size_t axis) const {
+  return axes[Input::axisIndex(device, axis)].error;
+}
+
+void AxisPredictor::sample() {
+  uint64_t now = input.frameTimeNS();
+  float dt = static_cast<float>(static_cast<double>(now - lastSampleNS) / Utility::NS_PER_SECOND);
+  bool first = lastSampleNS == 0 || now <= lastSampleNS;
+  lastSampleNS = now;
+
+  for(size_t index : activeAxes) {
+    AxisState& axis = axes[index];
+    bool mouse = isMouseAxis(index);
+    float position = mouse ? input.mouse().axes[index - InputFrame::MOUSE_AXIS_OFFSET] : input.gamepad().axes[index - InputFrame::GAMEPAD_AXIS_OFFSET];
+
+    //mouse deltas are already the motion since the previous sample
+    float previous = mouse ? 0 : axis.position;
+
+    if(first || axis.samples == 0) {
+      axis.position = position;
+      axis.samples = 1;
+      continue;
+    }
+
+    //score the prediction the previous sample would have made for this one
+    float predicted = previous + extrapolate(axis, dt);
+    axis.error += ERROR_SMOOTHING * (std::abs(predicted - position) - axis.error);
+
+    float velocity = (position - previous) / dt;
+    if(axis.samples >= VELOCITY_SAMPLES) {
+      float acceleration = (velocity - axis.rawVelocity) / dt;
+      axis.acceleration += axis.config.smoothing * (acceleration - axis.acceleration);
+      axis.velocity += axis.config.smoothing * (velocity - axis.velocity);
+    }
+    else {
+      axis.velocity = velocity;
+    }
+
+    axis.rawVelocity = velocity;
+    axis.position = position;
+    axis.samples++;
+  }
+}
+
+float AxisPredictor::extrapolate(const AxisState& axis, float seconds) const {
+  if(axis.samples < VELOCITY_SAMPLES) { return 0; }
+
+  float change = axis.velocity * seconds;
+  if(axis.config.model == Model::ACCELERATION && axis.samples >= ACCELERATION_SAMPLES) {
+    change += 0.5f * axis.acceleration * seconds * seconds;
+  }
+
+  return (std::max)(-axis.config.maxChange, (std::min)(axis.config.maxChange, change));
+}
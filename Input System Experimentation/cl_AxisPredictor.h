@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Extrapolates mouse and gamepad axes a short way into the future, to hide the time between the input
+//being sampled and the frame reaching the display (e.g. predict to the expected present time).
+//Every update() feeds each configured axis one timestamped sample, which updates smoothed velocity and
+//acceleration estimates in O(1). Axes are indexed the same way as InputFrame (mouse, then gamepad), and
+//start out with Model::NONE, which costs nothing.
+class AxisPredictor {
+public:
+  enum class Model { NONE, VELOCITY, ACCELERATION };
+
+  struct AxisConfig {
+    Model model = Model::NONE;
+
+    //extrapolation error grows quickly with distance, so the horizon is capped
+    float maxHorizonMS = 50;
+
+    //the predicted change from the last sample is clamped to this (in axis units, or counts for the mouse)
+    float maxChange = std::numeric_limits<float>::infinity();
+
+    //weight of each new sample in the velocity and acceleration estimates (1 = no smoothing)
+    float smoothing = 0.5f;
+  };
+
+  AxisPredictor(Input& input);
+  ~AxisPredictor();
+
+  AxisPredictor(const AxisPredictor&) = delete;
+  void operator=(const AxisPredictor&) = delete;
+
+  //throws for the keyboard, which has no axes
+  void configure(Input::DeviceType device, size_t axis, const AxisConfig& config);
+
+  //The axis extrapolated to 'timeNS' (steady_clock nanoseconds, like Input::frameTimeNS()). For the
+  //gamepad this is the predicted axis value, clamped to the axis range. Mouse axes are deltas, so for the
+  //mouse this is the motion expected between the last update() and 'timeNS'.
+  float predict(Input::DeviceType device, size_t axis, uint64_t timeNS) const;
+
+  //running mean of how far off the one-update-ahead prediction was, for judging whether prediction helps
+  float error(Input::DeviceType device, size_t axis) const;
+
+private:
+  struct AxisState {
+    AxisConfig config;
+
+    //the last sample (unused for the mouse, whose samples are already deltas)
+    float position = 0;
+    float velocity = 0;
+    float rawVelocity = 0;
+    float acceleration = 0;
+    float error = 0;
+
+    //samples seen since the axis was configured - the estimates aren't used until there are enough
+    unsigned int samples = 0;
+  };
+
+  Input& input;
+  Input::SubscriptionID frameSubscription;
+
+  std::array<AxisState, InputFrame::AXIS_CT> axes;
+  //indices into 'axes' of the axes that don't use Model::NONE
+  std::vector<size_t> activeAxes;
+  uint64_t lastSampleNS = 0;
+
+  void sample();
+  float extrapolate(const AxisState& axis, float seconds) const;
+  static bool isMouseAxis(size_t index) { return index < InputFrame::MOUSE_AXIS_OFFSET + InputFrame::MOUSE_AXIS_CT; }
+
+};
@@ -0,0 +1,145 @@
+#include "cl_DeviceWatcher.h"
+#include <Xinput.h>
+
+constexpr std::chrono::milliseconds DeviceWatcher::DEFAULT_XINPUT_POLL_INTERVAL;
+
+namespace {
+  class SystemSource : public DeviceWatcher::Source {
+  public:
+    bool describe(HANDLE device, DeviceWatcher::DeviceDesc& desc) override {
+      RID_DEVICE_INFO info;
+      info.cbSize = sizeof(info);
+      UINT size = sizeof(info);
+      if(GetRawInputDeviceInfoW(device, RIDI_DEVICEINFO, &info, &size) == static_cast<UINT>(-1)) { return false; }
+
+      switch(info.dwType) {
+      case RIM_TYPEMOUSE:    desc.kind = DeviceWatcher::DeviceDesc::RAW_MOUSE;    break;
+      case RIM_TYPEKEYBOARD: desc.kind = DeviceWatcher::DeviceDesc::RAW_KEYBOARD; break;
+      default:               desc.kind = DeviceWatcher::DeviceDesc::RAW_HID;      break;
+      }
+
+      UINT nameLen = 0;
+      GetRawInputDeviceInfoW(device, RIDI_DEVICENAME, nullptr, &nameLen);
+      if(nameLen > 0) {
+        desc.name.resize(nameLen);
+        GetRawInputDeviceInfoW(device, RIDI_DEVICENAME, &desc.name[0], &nameLen);
+        desc.name.resize(wcsnlen(desc.name.c_str(), nameLen));
+      }
+      return true;
+    }
+
+    bool xinputConnected(DWORD slot) override {
+      XINPUT_STATE xstate;
+      return XInputGetState(slot, &xstate) == ERROR_SUCCESS;
+    }
+  };
+}
+
+DeviceWatcher::DeviceWatcher(std::unique_ptr<Source> source, std::chrono::milliseconds xinputPollInterval) :
+  source(source ? std::move(source) : std::unique_ptr<Source>(new SystemSource())),
+  xinputPollInterval(xinputPollInterval)
+{
+  worker = std::thread([this]() { workerFn(); });
+}
+
+DeviceWatcher::~DeviceWatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  cv.notify_one();
+  worker.join();
+}
+
+void DeviceWatcher::notifyArrival(HANDLE device) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    requests.push_back(Request{ device, true });
+  }
+  cv.notify_one();
+}
+
+void DeviceWatcher::notifyRemoval(HANDLE device) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    requests.push_back(Request{ device, false });
+  }
+  cv.notify_one();
+}
+
+void DeviceWatcher::poll(std::vector<Change>& changes) {
+  changes.clear();
+
+  std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+  if(!lock) { return; }
+
+  //swapping hands the storage back and forth, so neither side reallocates once warmed up
+  changes.swap(completed);
+}
+
+void DeviceWatcher::workerFn() {
+  std::vector<Request> pending;
+  std::vector<Change> results;
+  auto nextXInputPoll = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mtx);
+  while(!stopping) {
+    cv.wait_until(lock, nextXInputPoll, [this]() { return stopping || !requests.empty(); });
+    if(stopping) { break; }
+
+    pending.swap(requests);
+
+    //descriptor queries can take a while, so they happen outside the lock
+    lock.unlock();
+
+    for(auto& request : pending) { processRequest(request, results); }
+    pending.clear();
+
+    auto now = std::chrono::steady_clock::now();
+    if(now >= nextXInputPoll) {
+      pollXInput(results);
+      nextXInputPoll = now + xinputPollInterval;
+    }
+
+    lock.lock();
+    completed.insert(completed.end(), results.begin(), results.end());
+    results.clear();
+  }
+}
+
+void DeviceWatcher::processRequest(const Request& request, std::vector<Change>& results) {
+  if(!request.arrived) {
+    //the device is already gone, so its description has to come from what we recorded on arrival
+    auto iter = known.find(request.handle);
+    if(iter == known.end()) { return; }
+
+    results.push_back(Change{ iter->second, false });
+    known.erase(iter);
+    return;
+  }
+
+  //the OS reports every present device on registration, so ignore anything we already know about
+  if(known.count(request.handle)) { return; }
+
+  DeviceDesc desc;
+  desc.handle = request.handle;
+  if(!source->describe(request.handle, desc)) { return; }
+
+  known[request.handle] = desc;
+  results.push_back(Change{ desc, true });
+}
+
+void DeviceWatcher::pollXInput(std::vector<Change>& results) {
+  for(DWORD slot = 0; slot < XUSER_MAX_COUNT; slot++) {
+    bool connected = source->xinputConnected(slot);
+    bool wasConnected = (xinputConnectedMask >> slot) & 1;
+    if(connected == wasConnected) { continue; }
+
+    xinputConnectedMask ^= 1 << slot;
+
+    DeviceDesc desc;
+    desc.kind = DeviceDesc::XINPUT;
+    desc.xinputSlot = slot;
+    results.push_back(Change{ desc, connected });
+  }
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+//Tracks device arrival and removal without stalling the game thread.
+//Raw input arrival/removal notifications (WM_INPUT_DEVICE_CHANGE) are handed to a worker thread, which
+//queries the device descriptors. The worker also polls the XInput slots, since XInputGetState on an
+//empty slot is notoriously slow. Completed changes are collected by the game thread with poll().
+//What the devices are comes from a Source, so tests can stand in for the OS.
+class DeviceWatcher {
+public:
+  struct DeviceDesc {
+    enum Kind { RAW_MOUSE, RAW_KEYBOARD, RAW_HID, XINPUT };
+    Kind kind;
+
+    //raw input device handle (null for XInput devices)
+    HANDLE handle = nullptr;
+
+    //XInput user index (XInput devices only)
+    DWORD xinputSlot = 0;
+
+    //device interface path (raw input devices only)
+    std::wstring name;
+  };
+
+  struct Change {
+    DeviceDesc desc;
+    //'arrived' is true if the device was connected, false if it was removed
+    bool arrived;
+  };
+
+  //The worker's view of the devices. Both queries are made on the worker thread.
+  class Source {
+  public:
+    virtual ~Source() = default;
+    //fills in the kind and name of a raw input device - false if it can't be queried (e.g. it's already gone)
+    virtual bool describe(HANDLE device, DeviceDesc& desc) = 0;
+    virtual bool xinputConnected(DWORD slot) = 0;
+  };
+
+  static constexpr std::chrono::milliseconds DEFAULT_XINPUT_POLL_INTERVAL{ 1000 };
+
+  //a null 'source' asks the OS (GetRawInputDeviceInfo() and XInputGetState())
+  explicit DeviceWatcher(std::unique_ptr<Source> source = nullptr, std::chrono::milliseconds xinputPollInterval = DEFAULT_XINPUT_POLL_INTERVAL);
+  ~DeviceWatcher();
+
+  DeviceWatcher(const DeviceWatcher&) = delete;
+  void operator=(const DeviceWatcher&) = delete;
+
+  //called from the window proc - these only queue the handle for the worker
+  void notifyArrival(HANDLE device);
+  void notifyRemoval(HANDLE device);
+
+  //Replaces the contents of 'changes' with the changes completed since the last poll.
+  //If the worker happens to be holding the lock then nothing is collected and the changes
+  //will be picked up by the next poll instead.
+  void poll(std::vector<Change>& changes);
+
+private:
+  std::unique_ptr<Source> source;
+  std::chrono::milliseconds xinputPollInterval;
+
+  struct Request {
+    HANDLE handle;
+    bool arrived;
+  };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool stopping = false;
+  std::vector<Request> requests;
+  std::vector<Change> completed;
+
+  //only touched by the worker
+  std::unordered_map<HANDLE, DeviceDesc> known;
+  unsigned int xinputConnectedMask = 0;
+
+  std::thread worker;
+
+  void workerFn();
+  void processRequest(const Request& request, std::vector<Change>& results);
+  void pollXInput(std::vector<Change>& results);
+
+};
@@ -0,0 +1,95 @@
+#include "cl_FramePacer.h"
+#include "ns_Utility.h"
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#pragma comment(lib, "winmm.lib")
+
+//older SDKs don't have this, but it is simply ignored by older versions of Windows
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+FramePacer::FramePacer(unsigned int periodUS) {
+  setPeriodUS(periodUS);
+
+  timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  highResolution = timer != nullptr;
+  if(!highResolution) {
+    //before Windows 10 1803 - a regular timer is only as fine as the scheduler granularity
+    timer = CreateWaitableTimerW(nullptr, TRUE, nullptr);
+    if(!timer) { throw std::runtime_error("Failed to create frame timer."); }
+    timeBeginPeriod(1);
+  }
+}
+
+FramePacer::~FramePacer() {
+  if(!highResolution) { timeEndPeriod(1); }
+  CloseHandle(timer);
+}
+
+void FramePacer::setPeriodUS(unsigned int periodUS) {
+  if(periodUS == 0) { throw std::runtime_error("Frame period must be nonzero."); }
+  periodNS = periodUS * 1000ull;
+}
+
+void FramePacer::beginFrame() {
+  uint64_t now = Utility::nowNS();
+  if(deadline == 0) { deadline = now; }
+
+  //a frame that ran long starts a new schedule rather than rushing to catch up
+  uint64_t nextDeadline = deadline + periodNS;
+  if(nextDeadline < now) { nextDeadline = now + periodNS; }
+  deadline = nextDeadline;
+
+  uint64_t lead = workEstimateNS + SAFETY_MARGIN_NS;
+  if(deadline > now + lead) { waitUntil(deadline - lead); }
+
+  workStart = Utility::nowNS();
+}
+
+void FramePacer::endFrame() {
+  uint64_t now = Utility::nowNS();
+
+  //the estimate jumps up to an expensive frame immediately but only eases down, since underestimating costs a deadline
+  uint64_t work = now - workStart;
+  if(work > workEstimateNS) { workEstimateNS = work; }
+  else { workEstimateNS -= (workEstimateNS - work) / WORK_DECAY; }
+
+  if(now > deadline) { frameStats.missedDeadlines++; }
+
+  if(lastFrameEnd != 0) {
+    double period = static_cast<double>(now - lastFrameEnd) / Utility::NS_PER_US;
+    double age = static_cast<double>(work) / Utility::NS_PER_US;
+    frameStats.frames++;
+    double delta = period - frameStats.meanPeriodUS;
+    frameStats.meanPeriodUS += delta / frameStats.frames;
+    periodM2 += delta * (period - frameStats.meanPeriodUS);
+    frameStats.jitterUS = std::sqrt(periodM2 / frameStats.frames);
+    frameStats.maxPeriodUS = (std::max)(frameStats.maxPeriodUS, period);
+    frameStats.meanInputAgeUS += (age - frameStats.meanInputAgeUS) / frameStats.frames;
+  }
+  frameStats.workEstimateUS = static_cast<double>(workEstimateNS) / Utility::NS_PER_US;
+  lastFrameEnd = now;
+}
+
+void FramePacer::resetStats() {
+  frameStats = Stats();
+  periodM2 = 0;
+  lastFrameEnd = 0;
+}
+
+void FramePacer::waitUntil(uint64_t timeNS) {
+  uint64_t now = Utility::nowNS();
+  if(timeNS > now + SPIN_NS) {
+    //relative due times are negative, in 100ns units
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -static_cast<long long>((timeNS - now - SPIN_NS) / 100);
+    if(SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+      WaitForSingleObject(timer, INFINITE);
+    }
+  }
+
+  while(Utility::nowNS() < timeNS) { YieldProcessor(); }
+}
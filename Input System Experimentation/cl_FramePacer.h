@@ -0,0 +1,78 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+
+//Paces the main loop to a fixed frame period and samples input as late in the frame as it can.
+//A frame looks like:
+//
+//  pacer.beginFrame();   //waits
+//  win.update();         //pumps the messages that arrived during the wait
+//  input.update();
+//  ...simulate and draw...
+//  gfx.present();
+//  pacer.endFrame();
+//
+//beginFrame() waits until the frame's work is expected to end right at the frame deadline, so the input
+//sampled after it is as fresh as possible. The work estimate tracks the recent worst case. Most of the wait
+//is done on a high resolution waitable timer, and the last SPIN_NS are spun, since an oversleep would
+//push the whole frame late.
+class FramePacer {
+public:
+  FramePacer(unsigned int periodUS);
+  ~FramePacer();
+
+  FramePacer(const FramePacer&) = delete;
+  void operator=(const FramePacer&) = delete;
+
+  void setPeriodUS(unsigned int periodUS);
+  unsigned int getPeriodUS() const { return static_cast<unsigned int>(periodNS / 1000); }
+
+  void beginFrame();
+  void endFrame();
+
+  struct Stats {
+    uint64_t frames = 0;
+
+    //time between consecutive endFrame() calls
+    double meanPeriodUS = 0;
+    double jitterUS = 0; //standard deviation
+    double maxPeriodUS = 0;
+
+    //frames that ended after their deadline
+    uint64_t missedDeadlines = 0;
+
+    //the current work estimate, and the time from the end of beginFrame() to endFrame() - which is how
+    //old the input is by the time the frame is presented
+    double workEstimateUS = 0;
+    double meanInputAgeUS = 0;
+  };
+  const Stats& stats() const { return frameStats; }
+  void resetStats();
+
+private:
+  //the timer overshoots by up to a few hundred microseconds, so the end of the wait is spun instead
+  static constexpr uint64_t SPIN_NS = 1000000;
+
+  //the estimate decays toward cheaper frames by 1/WORK_DECAY of the difference each frame
+  static constexpr uint64_t WORK_DECAY = 32;
+
+  //waking slightly early is free, whereas waking late misses the deadline
+  static constexpr uint64_t SAFETY_MARGIN_NS = 500000;
+
+  HANDLE timer;
+  //false if the high resolution timer isn't available and timeBeginPeriod() was used instead
+  bool highResolution;
+
+  uint64_t periodNS;
+  uint64_t deadline = 0;
+  uint64_t workStart = 0;
+  uint64_t workEstimateNS = 0;
+  uint64_t lastFrameEnd = 0;
+
+  Stats frameStats;
+  //Welford running variance of the frame period
+  double periodM2 = 0;
+
+  void waitUntil(uint64_t timeNS);
+
+};
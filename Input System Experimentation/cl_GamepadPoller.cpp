@@ -0,0 +1,56 @@
+#include "cl_GamepadPoller.h"
+#include "ns_Utility.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#pragma comment(lib, "winmm.lib")
+
+GamepadPoller::GamepadPoller(DWORD slot, unsigned int pollHz) : slot(slot), periodNS(pollHz ? 1000000000ull / pollHz : 0) {
+  if(pollHz == 0) { throw std::runtime_error("Gamepad poll rate must be nonzero."); }
+  worker = std::thread([this]() { workerFn(); });
+}
+
+GamepadPoller::~GamepadPoller() {
+  stopping = true;
+  worker.join();
+}
+
+void GamepadPoller::workerFn() {
+  //the default scheduler granularity is far too coarse for millisecond polling
+  timeBeginPeriod(1);
+
+  //the last state successfully queued - comparing against this rather than the last sample means a
+  //change that didn't fit in a full queue is retried on the next sample
+  XINPUT_GAMEPAD queued = {};
+  DWORD queuedPacket = 0;
+  bool connected = true;
+  uint64_t nextPoll = Utility::nowNS();
+
+  while(!stopping) {
+    XINPUT_STATE xstate = {};
+    bool success = XInputGetState(slot, &xstate) == ERROR_SUCCESS;
+    uint64_t sampleTime = Utility::nowNS();
+
+    //a removed pad reads as all zeroes so that held buttons get released
+    if(!success) { xstate = {}; }
+
+    bool differs = success != connected || (success && xstate.dwPacketNumber != queuedPacket);
+    if(differs) {
+      //the packet number can change without the reported state changing, which isn't worth an event
+      bool samePad = memcmp(&xstate.Gamepad, &queued, sizeof(queued)) == 0;
+      if(samePad || events.push(Event{ sampleTime, xstate.Gamepad })) {
+        queued = xstate.Gamepad;
+        queuedPacket = xstate.dwPacketNumber;
+        connected = success;
+      }
+    }
+
+    nextPoll += connected ? periodNS : DISCONNECTED_RETRY_NS;
+    uint64_t now = Utility::nowNS();
+    if(nextPoll < now) { nextPoll = now; }
+    std::this_thread::sleep_for(std::chrono::nanoseconds(nextPoll - now));
+  }
+
+  timeEndPeriod(1);
+}
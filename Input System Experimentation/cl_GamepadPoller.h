@@ -0,0 +1,44 @@
+#pragma once
+#include <Windows.h>
+#include <Xinput.h>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "cl_SpscRing.h"
+
+//Samples an XInput pad on a background thread at a fixed rate and queues every state change with its
+//timestamp, so that a button tapped and released between two frames still shows up.
+//Timestamps are steady_clock nanoseconds, the same clock Input::update() uses.
+class GamepadPoller {
+public:
+  struct Event {
+    uint64_t timeNS;
+    XINPUT_GAMEPAD pad;
+  };
+
+  GamepadPoller(DWORD slot, unsigned int pollHz);
+  ~GamepadPoller();
+
+  GamepadPoller(const GamepadPoller&) = delete;
+  void operator=(const GamepadPoller&) = delete;
+
+  //consumer side - returns false once the queue is empty
+  bool pop(Event& event) { return events.pop(event); }
+
+private:
+  //at 1 kHz this holds about a second of continuous stick movement
+  static constexpr size_t QUEUE_CAPACITY = 1024;
+
+  //how often an empty slot is retried, since XInputGetState on an empty slot is slow
+  static constexpr uint64_t DISCONNECTED_RETRY_NS = 1000000000;
+
+  const DWORD slot;
+  const uint64_t periodNS;
+
+  SpscRing<Event, QUEUE_CAPACITY> events;
+  std::atomic<bool> stopping{ false };
+  std::thread worker;
+
+  void workerFn();
+
+};
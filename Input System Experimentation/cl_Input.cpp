@@ -1,26 +1,288 @@
 #include "cl_Input.h"
+#include "cl_InputTelemetry.h"
+#include "cl_InputDigest.h"
+#include "ns_Utility.h"
 #include <Xinput.h>
+#include <imm.h>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #pragma comment(lib, "Xinput9_1_0.lib")
+#pragma comment(lib, "Imm32.lib")
+
+//the defaults are bound to references (vector::resize(), array::fill()), which needs a definition in C++14
+constexpr float Input::DEFAULT_DEAD_ZONE;
+constexpr unsigned int Input::DEFAULT_REPEAT_DELAY_MS;
+constexpr unsigned int Input::DEFAULT_REPEAT_PERIOD_MS;
+
+Input::Input(Window& win) : Input() {
+  deviceWatcher.reset(new DeviceWatcher());
 
-Input::Input(Window& win) : repeatDelayMS(DEFAULT_REPEAT_DELAY_MS), repeatPeriodMS(DEFAULT_REPEAT_PERIOD_MS) {
   constexpr size_t NUM_RIN_DEVICES = 2;
   RAWINPUTDEVICE devices[NUM_RIN_DEVICES] = {
-    RAWINPUTDEVICE{ 1, 2, 0, win.getHandle() }, //mouse
-    RAWINPUTDEVICE{ 1, 6, 0, win.getHandle() }  //kb
+    RAWINPUTDEVICE{ 1, 2, RIDEV_DEVNOTIFY, win.getHandle() }, //mouse
+    RAWINPUTDEVICE{ 1, 6, RIDEV_DEVNOTIFY, win.getHandle() }  //kb
   };
 
   RegisterRawInputDevices(devices, NUM_RIN_DEVICES, sizeof(RAWINPUTDEVICE));
 
   win.addProcFunc(WM_INPUT, [this](HWND hwnd, WPARAM wparam, LPARAM lparam) -> LRESULT { return procFn(hwnd, wparam, lparam); });
+  win.addProcFunc(WM_INPUT_DEVICE_CHANGE, [this](HWND hwnd, WPARAM wparam, LPARAM lparam) -> LRESULT { return deviceChangeProcFn(hwnd, wparam, lparam); });
+  win.addProcFunc(WM_CHAR,  [this](HWND hwnd, WPARAM wparam, LPARAM lparam) -> LRESULT { return charProcFn(hwnd, wparam, lparam); });
+
+  for(UINT message : { WM_IME_STARTCOMPOSITION, WM_IME_COMPOSITION, WM_IME_ENDCOMPOSITION }) {
+    win.addProcFunc(message, [this, message](HWND hwnd, WPARAM wparam, LPARAM lparam) -> LRESULT { return imeProcFn(hwnd, message, wparam, lparam); });
+  }
+}
+
+Input::Input() {
+  //room for every ID up front, so that applying a configuration never reallocates
+  repeatProfiles.reserve(static_cast<size_t>(std::numeric_limits<RepeatProfileID>::max()) + 1);
+  repeatProfiles.resize(DEFAULT_REPEAT + 1);
+  repeatProfiles[NEVER_REPEAT] = RepeatProfile{ 0, 0 };
+  setRepeatDelayMS(DEFAULT_REPEAT_DELAY_MS);
+  setRepeatPeriodMS(DEFAULT_REPEAT_PERIOD_MS);
+
+  for(DeviceType type : { DeviceType::KEYBOARD, DeviceType::MOUSE, DeviceType::GAMEPAD }) {
+    auto& state = device(type).state();
+    subscribers[static_cast<size_t>(type)].buttons.resize(state.buttons.size());
+    subscribers[static_cast<size_t>(type)].axes.resize(state.axes.size());
+  }
+
+  kbDev.setBuffer(&pressBuffer, InputFrame::KEYBOARD_BUTTON_OFFSET);
+  mouseDev.setBuffer(&pressBuffer, InputFrame::MOUSE_BUTTON_OFFSET);
+  xinputDev.setBuffer(&pressBuffer, InputFrame::GAMEPAD_BUTTON_OFFSET);
 }
 
+Input::~Input() = default;
+
 void Input::update() {
-  auto now = std::chrono::high_resolution_clock::now().time_since_epoch();
-  uint64_t frameTime = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
-  mouseDev.update(frameTime, *this);
-  kbDev.update(frameTime, *this);
+  update(Utility::nowNS());
+}
+
+void Input::update(uint64_t frameTime) {
+  frameCounter++;
+  lastFrameTime = frameTime;
+
+  //a reloaded configuration takes effect before anything of this frame is processed
+  if(configWatcher) {
+    if(const InputConfig* next = configWatcher->take()) {
+      configWatcher->retire(activeConfig.release());
+      activeConfig.reset(next);
+      applyConfig(*next, frameTime);
+    }
+  }
+
+  if(telemetryData) { telemetryData->beginFrame(frameTime); }
+  pressBuffer.beginFrame(frameTime);
+
+  //the merged keyboard and mouse are fed by the physical devices
+  mouseDev.beginUpdate();
+  kbDev.beginUpdate();
+  for(auto& physical : physicalDeviceList) { physical.device->beginUpdate(); }
+
+  dispatchEvents(frameTime);
+
+  //Removed devices release their buttons into the merged devices, so this has to happen after beginUpdate().
+  //It also has to come after the events, or else a removed device's last events would bring it back.
+  applyDeviceChanges();
+
+  for(auto& physical : physicalDeviceList) { physical.device->endUpdate(frameTime, *this); }
+  mouseDev.endUpdate(frameTime, *this);
+  kbDev.endUpdate(frameTime, *this);
+
   xinputDev.update(frameTime, *this);
+  textDev.update();
+  updateButtonWords();
+
+  if(inputDigest) { inputDigest->update(frameCounter, kbDev.state(), mouseDev.state(), xinputDev.state()); }
+
+  if(frameHistory) {
+    captureFrame(historyScratch);
+    frameHistory->push(historyScratch);
+  }
+
+  dispatchSubscribers();
+}
+
+void Input::captureFrame(InputFrame& frame) const {
+  static_assert(InputFrame::KEYBOARD_BUTTON_CT == KeyboardDevice::BUTTON_CT, "InputFrame keyboard layout is out of date");
+  static_assert(InputFrame::MOUSE_BUTTON_CT == MouseDevice::BUTTON_CT && InputFrame::MOUSE_AXIS_CT == MouseDevice::AXIS_CT, "InputFrame mouse layout is out of date");
+  static_assert(InputFrame::GAMEPAD_BUTTON_CT == GamepadDevice::BUTTON_CT && InputFrame::GAMEPAD_AXIS_CT == GamepadDevice::AXIS_CT, "InputFrame gamepad layout is out of date");
+
+  frame.frameNumber = frameCounter;
+  frame.buttons = heldBits;
+
+  auto& mouse = mouseDev.state();
+  for(size_t i = 0; i < InputFrame::MOUSE_AXIS_CT; i++) {
+    frame.axes[InputFrame::MOUSE_AXIS_OFFSET + i] = InputFrame::quantizeCount(mouse.axes[i]);
+  }
+
+  auto& pad = xinputDev.state();
+  for(size_t i = 0; i < InputFrame::GAMEPAD_AXIS_CT; i++) {
+    frame.axes[InputFrame::GAMEPAD_AXIS_OFFSET + i] = InputFrame::quantizeUnit(pad.axes[i]);
+  }
+}
+
+InputTelemetry& Input::enableTelemetry() {
+  telemetryData.reset(new InputTelemetry());
+  kbDev.setTelemetry(telemetryData.get(), DeviceType::KEYBOARD);
+  mouseDev.setTelemetry(telemetryData.get(), DeviceType::MOUSE);
+  xinputDev.setTelemetry(telemetryData.get(), DeviceType::GAMEPAD);
+  return *telemetryData;
+}
+
+void Input::disableTelemetry() {
+  kbDev.setTelemetry(nullptr, DeviceType::KEYBOARD);
+  mouseDev.setTelemetry(nullptr, DeviceType::MOUSE);
+  xinputDev.setTelemetry(nullptr, DeviceType::GAMEPAD);
+  telemetryData.reset();
+}
+
+InputDigest& Input::enableDigest() {
+  captureFrame(historyScratch);
+  inputDigest.reset(new InputDigest(historyScratch));
+  return *inputDigest;
+}
+
+void Input::disableDigest() {
+  inputDigest.reset();
+}
+
+bool Input::pressedWithin(DeviceType device, size_t button, unsigned int ms) const {
+  return pressBuffer.pressedWithin(controlBit(device, button), ms * Utility::NS_PER_MS);
+}
+
+bool Input::releasedWithin(DeviceType device, size_t button, unsigned int ms) const {
+  return pressBuffer.releasedWithin(controlBit(device, button), ms * Utility::NS_PER_MS);
+}
+
+bool Input::consumePress(DeviceType device, size_t button) {
+  return pressBuffer.consumePress(controlBit(device, button));
+}
+
+size_t Input::controlBit(DeviceType device, size_t button) {
+  switch(device) {
+  case DeviceType::KEYBOARD: return InputFrame::KEYBOARD_BUTTON_OFFSET + button;
+  case DeviceType::MOUSE:    return InputFrame::MOUSE_BUTTON_OFFSET + button;
+  default:                   return InputFrame::GAMEPAD_BUTTON_OFFSET + button;
+  }
+}
+
+size_t Input::axisIndex(DeviceType device, size_t axis) {
+  switch(device) {
+  case DeviceType::MOUSE:
+    if(axis >= InputFrame::MOUSE_AXIS_CT) { break; }
+    return InputFrame::MOUSE_AXIS_OFFSET + axis;
+  case DeviceType::GAMEPAD:
+    if(axis >= InputFrame::GAMEPAD_AXIS_CT) { break; }
+    return InputFrame::GAMEPAD_AXIS_OFFSET + axis;
+  default:
+    break;
+  }
+  throw std::runtime_error("Invalid axis.");
+}
+
+const Input::ButtonWords& Input::deviceMask(DeviceType device) {
+  static const std::array<ButtonWords, 3> masks = []() {
+    std::array<ButtonWords, 3> built = {};
+    const size_t counts[] = { InputFrame::KEYBOARD_BUTTON_CT, InputFrame::MOUSE_BUTTON_CT, InputFrame::GAMEPAD_BUTTON_CT };
+    for(DeviceType type : { DeviceType::KEYBOARD, DeviceType::MOUSE, DeviceType::GAMEPAD }) {
+      for(size_t i = 0; i < counts[static_cast<size_t>(type)]; i++) {
+        size_t bit = controlBit(type, i);
+        built[static_cast<size_t>(type)][bit / 64] |= uint64_t(1) << (bit % 64);
+      }
+    }
+    return built;
+  }();
+  return masks[static_cast<size_t>(device)];
+}
+
+void Input::updateButtonWords() {
+  triggeredBits.fill(0);
+  releasedBits.fill(0);
+  for(DeviceType type : { DeviceType::KEYBOARD, DeviceType::MOUSE, DeviceType::GAMEPAD }) {
+    auto& state = device(type).state();
+    //every press and release lists its button in changedButtons, so the rest of the held bits still hold
+    for(size_t i : state.changedButtons) {
+      size_t bit = controlBit(type, i);
+      uint64_t mask = uint64_t(1) << (bit % 64);
+      if(state.buttons[i].held) { heldBits[bit / 64] |= mask; }
+      else                      { heldBits[bit / 64] &= ~mask; }
+      if(state.buttons[i].triggered) { triggeredBits[bit / 64] |= mask; }
+      if(state.buttons[i].released)  { releasedBits[bit / 64] |= mask; }
+    }
+  }
+}
+
+const Input::DeviceButton& Input::controlButton(size_t control) const {
+  if(control < InputFrame::MOUSE_BUTTON_OFFSET) { return kbDev.state().buttons[control - InputFrame::KEYBOARD_BUTTON_OFFSET]; }
+  if(control < InputFrame::GAMEPAD_BUTTON_OFFSET) { return mouseDev.state().buttons[control - InputFrame::MOUSE_BUTTON_OFFSET]; }
+  return xinputDev.state().buttons[control - InputFrame::GAMEPAD_BUTTON_OFFSET];
+}
+
+void Input::watchConfig(const std::string& path) {
+  configWatcher.reset();
+  configWatcher.reset(new InputConfigWatcher(path));
+}
+
+void Input::stopWatchingConfig() {
+  configWatcher.reset();
+}
+
+InputConfigWatcher::Status Input::configStatus() const {
+  return configWatcher ? configWatcher->status() : InputConfigWatcher::Status{ 0, 0, std::string() };
+}
+
+void Input::setConfig(std::unique_ptr<const InputConfig> config) {
+  if(!config) { throw std::runtime_error("Null input configuration."); }
+  activeConfig = std::move(config);
+  applyConfig(*activeConfig, lastFrameTime);
+}
+
+void Input::applyConfig(const InputConfig& config, uint64_t frameTime) {
+  //everything is copied into storage that already has room for it, so nothing here allocates
+  auto& zones = config.deadZones();
+  std::copy(zones.begin(), zones.end(), xinputDev.deadZones.begin());
+  xinputDev.refreshAxes();
+
+  //A reload that leaves a held button's repeat timing alone (e.g. one that only edits a dead zone) must not
+  //disturb its repeats, so only the profiles whose timing differs from before count as retimed.
+  auto& profiles = config.repeatProfiles();
+  RepeatProfileSet retimed;
+  size_t previousCount = repeatProfiles.size();
+  repeatProfiles.resize(profiles.size());
+  for(size_t i = 0; i < profiles.size(); i++) {
+    RepeatProfile profile = { profiles[i].delayMS * Utility::NS_PER_MS, profiles[i].periodMS * Utility::NS_PER_MS };
+    if(i >= previousCount || profile.delayNS != repeatProfiles[i].delayNS || profile.periodNS != repeatProfiles[i].periodNS) { retimed.set(i); }
+    repeatProfiles[i] = profile;
+  }
+
+  auto& buttonProfiles = config.buttonProfiles();
+  kbDev.setRepeatProfiles(buttonProfiles.data() + InputFrame::KEYBOARD_BUTTON_OFFSET, retimed, frameTime);
+  mouseDev.setRepeatProfiles(buttonProfiles.data() + InputFrame::MOUSE_BUTTON_OFFSET, retimed, frameTime);
+  xinputDev.setRepeatProfiles(buttonProfiles.data() + InputFrame::GAMEPAD_BUTTON_OFFSET, retimed, frameTime);
+  for(auto& physical : physicalDeviceList) {
+    physical.device->setRepeatProfiles(buttonProfiles.data() + controlBit(physical.type, 0), retimed, frameTime);
+  }
+}
+
+bool Input::actionFlag(ActionID action, bool DeviceButton::*flag) const {
+  if(!activeConfig) { return false; }
+
+  size_t count;
+  const uint16_t* controls = activeConfig->bindings(action, count);
+  for(size_t i = 0; i < count; i++) {
+    if(controlButton(controls[i]).*flag) { return true; }
+  }
+  return false;
+}
+
+InputHistory& Input::enableHistory(size_t capacity) {
+  frameHistory.reset(new InputHistory(capacity));
+  return *frameHistory;
 }
 
 float Input::getGamepadDeadZone(int axis) {
@@ -29,6 +291,287 @@ float Input::getGamepadDeadZone(int axis) {
 
 void Input::setGamepadDeadZone(int axis, float zoneRadius) {
   xinputDev.deadZones[axis] = zoneRadius;
+
+  xinputDev.refreshAxes();
+}
+
+std::array<float, InputFrame::GAMEPAD_AXIS_CT> Input::peekGamepad() const {
+  //synthetic states stand in for the pad until the next update() applies them
+  XINPUT_STATE xstate = {};
+  if(!xinputDev.injectedStates.empty()) { xstate.Gamepad = xinputDev.injectedStates.back().pad; }
+  else if(xinputDev.connected && XInputGetState(0, &xstate) != ERROR_SUCCESS) { xstate = {}; }
+
+  std::array<float, InputFrame::GAMEPAD_AXIS_CT> axes;
+  xinputDev.deadZonedAxes(xstate.Gamepad, axes.data());
+  return axes;
+}
+
+void Input::enableGamepadPolling(unsigned int pollHz) {
+  xinputDev.poller.reset();
+  xinputDev.poller.reset(new GamepadPoller(0, pollHz));
+}
+
+void Input::disableGamepadPolling() {
+  xinputDev.poller.reset();
+}
+
+Input::RepeatProfileID Input::addRepeatProfile(unsigned int delayMS, unsigned int periodMS) {
+  if(repeatProfiles.size() > std::numeric_limits<RepeatProfileID>::max()) {
+    throw std::runtime_error("Too many repeat profiles.");
+  }
+  if(periodMS == 0) { throw std::runtime_error("Repeat period must be nonzero."); }
+
+  repeatProfiles.push_back(RepeatProfile{ delayMS * Utility::NS_PER_MS, periodMS * Utility::NS_PER_MS });
+  return static_cast<RepeatProfileID>(repeatProfiles.size() - 1);
+}
+
+void Input::setRepeatProfile(DeviceType type, size_t button, RepeatProfileID profile) {
+  if(profile >= repeatProfiles.size()) { throw std::runtime_error("Invalid repeat profile."); }
+  device(type).setRepeatProfile(button, profile, lastFrameTime);
+
+  for(auto& physical : physicalDeviceList) {
+    if(physical.type == type) { physical.device->setRepeatProfile(button, profile, lastFrameTime); }
+  }
+}
+
+Input::RepeatProfileID Input::getRepeatProfile(DeviceType type, size_t button) const {
+  return device(type).getRepeatProfile(button);
+}
+
+unsigned int Input::getRepeatDelayMS() const {
+  return static_cast<unsigned int>(repeatProfiles[DEFAULT_REPEAT].delayNS / Utility::NS_PER_MS);
+}
+
+void Input::setRepeatDelayMS(unsigned int milliseconds) {
+  repeatProfiles[DEFAULT_REPEAT].delayNS = milliseconds * Utility::NS_PER_MS;
+  restartRepeats(DEFAULT_REPEAT);
+}
+
+unsigned int Input::getRepeatPeriodMS() const {
+  return static_cast<unsigned int>(repeatProfiles[DEFAULT_REPEAT].periodNS / Utility::NS_PER_MS);
+}
+
+void Input::setRepeatPeriodMS(unsigned int milliseconds) {
+  if(milliseconds == 0) { throw std::runtime_error("Repeat period must be nonzero."); }
+  repeatProfiles[DEFAULT_REPEAT].periodNS = milliseconds * Utility::NS_PER_MS;
+  restartRepeats(DEFAULT_REPEAT);
+}
+
+void Input::restartRepeats(RepeatProfileID profile) {
+  kbDev.restartRepeats(profile, lastFrameTime);
+  mouseDev.restartRepeats(profile, lastFrameTime);
+  xinputDev.restartRepeats(profile, lastFrameTime);
+  for(auto& physical : physicalDeviceList) { physical.device->restartRepeats(profile, lastFrameTime); }
+}
+
+Input::SubscriptionID Input::subscribe(DeviceType type, size_t button, ButtonEvent event, ButtonCallback callback) {
+  auto& table = subscribers[static_cast<size_t>(type)].buttons;
+  if(button >= table.controlCount()) { throw std::runtime_error("Invalid button."); }
+
+  SubscriptionID id = nextSubscriptionID++;
+  ButtonSubscriber entry{ id, event, std::move(callback) };
+  if(dispatchingSubscribers) {
+    deferredSubscriberChanges.push_back([&table, button, entry]() { table.insert(button, entry); });
+  }
+  else {
+    table.insert(button, std::move(entry));
+  }
+  return id;
+}
+
+Input::SubscriptionID Input::subscribeAxis(DeviceType type, size_t axis, float threshold, AxisCallback callback) {
+  auto& table = subscribers[static_cast<size_t>(type)].axes;
+  if(axis >= table.controlCount()) { throw std::runtime_error("Invalid axis."); }
+
+  SubscriptionID id = nextSubscriptionID++;
+  AxisSubscriber entry{ id, threshold, device(type).state().axes[axis], std::move(callback) };
+  if(dispatchingSubscribers) {
+    deferredSubscriberChanges.push_back([&table, axis, entry]() { table.insert(axis, entry); });
+  }
+  else {
+    table.insert(axis, std::move(entry));
+  }
+  return id;
+}
+
+Input::SubscriptionID Input::subscribeFrame(std::function<void()> callback) {
+  SubscriptionID id = nextSubscriptionID++;
+  FrameSubscriber entry{ id, std::move(callback) };
+  if(dispatchingSubscribers) {
+    deferredSubscriberChanges.push_back([this, entry]() { frameSubscribers.push_back(entry); });
+  }
+  else {
+    frameSubscribers.push_back(std::move(entry));
+  }
+  return id;
+}
+
+void Input::unsubscribe(SubscriptionID id) {
+  if(id == UNSUBSCRIBED) { return; }
+
+  for(auto& sub : frameSubscribers) {
+    if(sub.id != id) { continue; }
+    if(dispatchingSubscribers) {
+      sub.id = UNSUBSCRIBED;
+      deferredSubscriberChanges.push_back([this]() { eraseFrameSubscriber(UNSUBSCRIBED); });
+    }
+    else {
+      eraseFrameSubscriber(id);
+    }
+    return;
+  }
+
+  for(auto& subs : subscribers) {
+    if(!dispatchingSubscribers) {
+      if(subs.buttons.erase(id) || subs.axes.erase(id)) { return; }
+      continue;
+    }
+
+    //the callback being removed may be the one that is running, so it can't be destroyed yet
+    if(auto entry = subs.buttons.find(id)) {
+      entry->id = UNSUBSCRIBED;
+      deferredSubscriberChanges.push_back([&subs]() { subs.buttons.erase(UNSUBSCRIBED); });
+      return;
+    }
+    if(auto entry = subs.axes.find(id)) {
+      entry->id = UNSUBSCRIBED;
+      deferredSubscriberChanges.push_back([&subs]() { subs.axes.erase(UNSUBSCRIBED); });
+      return;
+    }
+  }
+
+  //a subscription made during this dispatch is still waiting to be inserted
+  if(dispatchingSubscribers) {
+    deferredSubscriberChanges.push_back([this, id]() { unsubscribe(id); });
+  }
+}
+
+void Input::dispatchSubscribers() {
+  //Ends the dispatch on the way out, including when a callback throws, so that subscribing works again and
+  //the changes deferred so far still take effect. The deferred changes can themselves defer nothing, since
+  //dispatch is over by then.
+  struct DispatchScope {
+    Input& input;
+    explicit DispatchScope(Input& input) : input(input) { input.dispatchingSubscribers = true; }
+    ~DispatchScope() {
+      input.dispatchingSubscribers = false;
+      for(auto& change : input.deferredSubscriberChanges) { change(); }
+      input.deferredSubscriberChanges.clear();
+    }
+  } scope(*this);
+
+  for(DeviceType type : { DeviceType::KEYBOARD, DeviceType::MOUSE, DeviceType::GAMEPAD }) {
+    auto& subs = subscribers[static_cast<size_t>(type)];
+    auto& state = device(type).state();
+
+    if(!subs.buttons.entries.empty()) {
+      for(size_t index : state.changedButtons) {
+        const DeviceButton& btn = state.buttons[index];
+        for(uint32_t i = subs.buttons.first[index]; i < subs.buttons.first[index + 1]; i++) {
+          auto& sub = subs.buttons.entries[i];
+          bool fire = false;
+          switch(sub.event) {
+          case ButtonEvent::TRIGGERED: fire = btn.triggered; break;
+          case ButtonEvent::RELEASED:  fire = btn.released;  break;
+          case ButtonEvent::REPEATED:  fire = btn.repeating; break;
+          }
+          if(fire && sub.id != UNSUBSCRIBED) { sub.callback(btn); }
+        }
+      }
+    }
+
+    if(!subs.axes.entries.empty()) {
+      for(size_t index : state.changedAxes) {
+        float value = state.axes[index];
+        for(uint32_t i = subs.axes.first[index]; i < subs.axes.first[index + 1]; i++) {
+          auto& sub = subs.axes.entries[i];
+          if(sub.id == UNSUBSCRIBED || std::abs(value - sub.lastValue) < sub.threshold) { continue; }
+          sub.lastValue = value;
+          sub.callback(value);
+        }
+      }
+    }
+  }
+
+  for(size_t i = 0; i < frameSubscribers.size(); i++) {
+    if(frameSubscribers[i].id != UNSUBSCRIBED) { frameSubscribers[i].callback(); }
+  }
+}
+
+void Input::eraseFrameSubscriber(SubscriptionID id) {
+  auto it = std::find_if(frameSubscribers.begin(), frameSubscribers.end(), [id](const FrameSubscriber& sub) { return sub.id == id; });
+  if(it != frameSubscribers.end()) { frameSubscribers.erase(it); }
+}
+
+Input::Device& Input::device(DeviceType type) {
+  return const_cast<Device&>(static_cast<const Input*>(this)->device(type));
+}
+
+const Input::Device& Input::device(DeviceType type) const {
+  switch(type) {
+  case DeviceType::KEYBOARD: return kbDev;
+  case DeviceType::MOUSE:    return mouseDev;
+  case DeviceType::GAMEPAD:  return xinputDev;
+  }
+  throw std::runtime_error("Invalid device type.");
+}
+
+const std::vector<Input::DeviceID>& Input::physicalDevices(DeviceType type) const {
+  switch(type) {
+  case DeviceType::KEYBOARD: return physicalKeyboardIDs;
+  case DeviceType::MOUSE:    return physicalMouseIDs;
+  default: throw std::runtime_error("Only keyboards and mice have physical device states.");
+  }
+}
+
+const Input::DeviceState& Input::physicalDevice(DeviceID id) const {
+  auto iter = physicalSlots.find(id);
+  if(iter == physicalSlots.end()) { throw std::runtime_error("Unknown physical device."); }
+  return physicalDeviceList[iter->second].device->state();
+}
+
+Input::Device& Input::physicalDevice(DeviceID id, DeviceType type) {
+  auto iter = physicalSlots.find(id);
+  if(iter != physicalSlots.end()) { return *physicalDeviceList[iter->second].device; }
+
+  //first time we've seen this device, so give it a slot
+  PhysicalDevice physical{ type, id, nullptr };
+  if(type == DeviceType::KEYBOARD) {
+    physical.device.reset(new KeyboardDevice());
+    physicalKeyboardIDs.push_back(id);
+  }
+  else {
+    physical.device.reset(new MouseDevice());
+    physicalMouseIDs.push_back(id);
+  }
+
+  Device& merged = device(type);
+  physical.device->setAggregate(&merged);
+  physical.device->copyRepeatProfiles(merged);
+
+  physicalSlots[id] = physicalDeviceList.size();
+  physicalDeviceList.push_back(std::move(physical));
+  return *physicalDeviceList.back().device;
+}
+
+void Input::retirePhysicalDevice(DeviceID id) {
+  auto iter = physicalSlots.find(id);
+  if(iter == physicalSlots.end()) { return; }
+
+  size_t slot = iter->second;
+  PhysicalDevice& physical = physicalDeviceList[slot];
+  physical.device->releaseAll();
+
+  auto& ids = physical.type == DeviceType::KEYBOARD ? physicalKeyboardIDs : physicalMouseIDs;
+  ids.erase(std::find(ids.begin(), ids.end(), id));
+
+  //swap the last slot into the hole so the other slots stay put
+  physicalSlots.erase(iter);
+  if(slot != physicalDeviceList.size() - 1) {
+    physicalDeviceList[slot] = std::move(physicalDeviceList.back());
+    physicalSlots[physicalDeviceList[slot].id] = slot;
+  }
+  physicalDeviceList.pop_back();
 }
 
 LRESULT Input::procFn(HWND hwnd, WPARAM wparam, LPARAM lparam) {
@@ -39,35 +582,254 @@ LRESULT Input::procFn(HWND hwnd, WPARAM wparam, LPARAM lparam) {
   RAWINPUT rin;
   UINT size = sizeof(RAWINPUT);
   GetRawInputData(reinterpret_cast<HRAWINPUT>(lparam), RID_INPUT, &rin, &size, sizeof(RAWINPUTHEADER));
+  routeEvent(rin);
+
+  return 0;
+}
+
+void Input::routeEvent(const RAWINPUT& rin) {
+  if(rin.header.dwType != RIM_TYPEMOUSE && rin.header.dwType != RIM_TYPEKEYBOARD) { return; }
+
+  eventQueue.push(rin);
+  if(rin.header.dwType == RIM_TYPEMOUSE) {
+    pendingMouseMotion[Mouse::DELTA_X] += rin.data.mouse.lLastX;
+    pendingMouseMotion[Mouse::DELTA_Y] += rin.data.mouse.lLastY;
+    pendingMouseMotion[Mouse::DELTA_WHEEL] += static_cast<short>(rin.data.mouse.usButtonData);
+  }
+  if(eventQueue.size() > eventQueueMax) { eventQueueMax = eventQueue.size(); }
+}
+
+void Input::dispatchEvents(uint64_t frameTime) {
+  while(!eventQueue.empty()) {
+    auto& rin = eventQueue.front();
+    DeviceType type = rin.header.dwType == RIM_TYPEMOUSE ? DeviceType::MOUSE : DeviceType::KEYBOARD;
+    physicalDevice(rin.header.hDevice, type).handleEvent(rin, frameTime);
+    if(telemetryData) { telemetryData->countEvent(type); }
+    eventQueue.pop();
+  }
+  pendingMouseMotion.fill(0);
+}
+
+void Input::injectEvent(const RAWINPUT& event) {
+  routeEvent(event);
+}
+
+void Input::injectGamepadState(const XINPUT_GAMEPAD& pad, uint64_t timeNS) {
+  xinputDev.injectedStates.push_back(GamepadPoller::Event{ timeNS, pad });
+}
+
+size_t Input::eventQueueHighWater() const {
+  return eventQueueMax;
+}
+
+void Input::resetEventQueueHighWater() {
+  eventQueueMax = eventQueue.size();
+}
+
+LRESULT Input::deviceChangeProcFn(HWND hwnd, WPARAM wparam, LPARAM lparam) {
+  HANDLE device = reinterpret_cast<HANDLE>(lparam);
+  if(wparam == GIDC_ARRIVAL) { deviceWatcher->notifyArrival(device); }
+  if(wparam == GIDC_REMOVAL) { deviceWatcher->notifyRemoval(device); }
+  return 0;
+}
 
-  switch(rin.header.dwType) {
-  case RIM_TYPEMOUSE: mouseDev.enqueueEvent(rin); break;
-  case RIM_TYPEKEYBOARD: kbDev.enqueueEvent(rin); break;
+void Input::watchDevices(std::unique_ptr<DeviceWatcher> watcher) {
+  deviceWatcher = std::move(watcher);
+}
+
+void Input::applyDeviceChanges() {
+  if(!deviceWatcher) { return; }
+  deviceWatcher->poll(deviceChangeList);
+
+  for(auto& change : deviceChangeList) {
+    auto& desc = change.desc;
+    if(desc.kind == DeviceDesc::XINPUT && desc.xinputSlot == 0) { xinputDev.connected = change.arrived; }
+    if(desc.kind == DeviceDesc::RAW_KEYBOARD) {
+      if(change.arrived) { physicalDevice(desc.handle, DeviceType::KEYBOARD); }
+      else { retirePhysicalDevice(desc.handle); }
+    }
+    if(desc.kind == DeviceDesc::RAW_MOUSE) {
+      if(change.arrived) { physicalDevice(desc.handle, DeviceType::MOUSE); }
+      else { retirePhysicalDevice(desc.handle); }
+    }
+
+    if(change.arrived) {
+      connectedDeviceList.push_back(desc);
+      continue;
+    }
+
+    auto match = [&desc](const DeviceDesc& other) {
+      return other.kind == desc.kind && other.handle == desc.handle && other.xinputSlot == desc.xinputSlot;
+    };
+    connectedDeviceList.erase(std::remove_if(connectedDeviceList.begin(), connectedDeviceList.end(), match), connectedDeviceList.end());
+  }
+}
+
+LRESULT Input::charProcFn(HWND hwnd, WPARAM wparam, LPARAM lparam) {
+  if(IsWindowUnicode(hwnd)) {
+    textDev.enqueueUnit(static_cast<wchar_t>(wparam));
+    return 0;
   }
 
+  //multibyte windows deliver characters in the active code page, a byte per message
+  textDev.enqueueByte(static_cast<char>(wparam));
   return 0;
 }
 
+LRESULT Input::imeProcFn(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+  switch(message) {
+  case WM_IME_STARTCOMPOSITION:
+    textDev.beginComposition();
+    break;
+
+  case WM_IME_COMPOSITION: {
+    HIMC imc = (lparam & (GCS_COMPSTR | GCS_RESULTSTR)) ? ImmGetContext(hwnd) : nullptr;
+    if(!imc) { break; }
+
+    //The committed string is read here as UTF-16 rather than left to the default proc, which would send it
+    //to an ANSI window as WM_CHAR bytes in the active code page. So the message isn't passed on when it
+    //carries a result, or the string would arrive twice.
+    bool handledResult = false;
+    if(lparam & GCS_RESULTSTR) {
+      wchar_t units[TEXT_CAPACITY];
+      LONG needed = ImmGetCompositionStringW(imc, GCS_RESULTSTR, nullptr, 0);
+      LONG bytes = ImmGetCompositionStringW(imc, GCS_RESULTSTR, units, sizeof(units));
+      if(bytes >= 0) {
+        for(LONG i = 0; i < bytes / static_cast<LONG>(sizeof(wchar_t)); i++) { textDev.enqueueUnit(units[i]); }
+        //anything past TEXT_CAPACITY units couldn't fit in the frame's text anyway
+        if(needed > bytes) { textDev.markOverflowed(); }
+        handledResult = true;
+      }
+    }
+
+    if(lparam & GCS_COMPSTR) {
+      wchar_t units[COMPOSITION_CAPACITY];
+      LONG bytes = ImmGetCompositionStringW(imc, GCS_COMPSTR, units, sizeof(units));
+      if(bytes >= 0) { textDev.setComposition(units, bytes / sizeof(wchar_t)); }
+    }
+
+    ImmReleaseContext(hwnd, imc);
+    if(handledResult) { return 0; }
+    break;
+  }
+
+  case WM_IME_ENDCOMPOSITION:
+    textDev.endComposition();
+    break;
+  }
+
+  return DefWindowProc(hwnd, message, wparam, lparam);
+}
+
 //////////////////////////////////////////////////////////
 
 Input::Device::Device(size_t buttonCt, size_t axisCt) {
   devState.buttons.resize(buttonCt);
-  repeatData.resize(buttonCt);
+  repeatData.resize(buttonCt, ButtonRepeatData{ 0, 0, DEFAULT_REPEAT });
   devState.axes.resize(axisCt);
+  prevAxes.resize(axisCt);
+
+  //reserved up front so that building the lists never allocates
+  devState.changedButtons.reserve(buttonCt);
+  devState.changedAxes.reserve(axisCt);
+
+  repeatButtons.resize(buttonCt);
+  for(size_t i = 0; i < buttonCt; i++) { repeatButtons[i] = i; }
+
+  holdCounts.resize(buttonCt);
+}
+
+void Input::Device::copyRepeatProfiles(const Device& other) {
+  for(size_t i = 0; i < repeatData.size(); i++) { repeatData[i].profile = other.repeatData[i].profile; }
+  repeatButtons = other.repeatButtons;
+}
+
+void Input::Device::setRepeatProfile(size_t index, RepeatProfileID profile, uint64_t frameTime) {
+  repeatData[index].profile = profile;
+  restartRepeat(index, frameTime);
+
+  //rebuild the repeat list in index order - this only happens at configuration time
+  repeatButtons.clear();
+  for(size_t i = 0; i < repeatData.size(); i++) {
+    if(repeatData[i].profile != NEVER_REPEAT) { repeatButtons.push_back(i); }
+  }
+}
+
+void Input::Device::setRepeatProfiles(const RepeatProfileID* profiles, const RepeatProfileSet& retimed, uint64_t frameTime) {
+  //repeatButtons has room for every button, so rebuilding it never allocates
+  repeatButtons.clear();
+  for(size_t i = 0; i < repeatData.size(); i++) {
+    bool restart = repeatData[i].profile != profiles[i] || retimed[profiles[i]];
+    repeatData[i].profile = profiles[i];
+    if(profiles[i] != NEVER_REPEAT) { repeatButtons.push_back(i); }
+    if(restart) { restartRepeat(i, frameTime); }
+  }
+}
+
+void Input::Device::restartRepeats(RepeatProfileID profile, uint64_t frameTime) {
+  for(size_t i : repeatButtons) {
+    if(repeatData[i].profile == profile) { restartRepeat(i, frameTime); }
+  }
+}
+
+void Input::Device::restartRepeat(size_t index, uint64_t frameTime) {
+  //the repeats counted so far were timed by the old profile, so they would be meaningless under the new one
+  if(!devState.buttons[index].held) { return; }
+  repeatData[index].triggerTimeNS = frameTime;
+  repeatData[index].repeatPrev = 0;
 }
 
 void Input::Device::update(uint64_t frameTime, const Input& input) {
-  for(auto& button : devState.buttons) { resetButton(button); }
+  beginUpdate();
+  endUpdate(frameTime, input);
+}
+
+void Input::Device::beginUpdate() {
+  //only the buttons listed last frame can have any per-frame flags set
+  for(size_t i : devState.changedButtons) { resetButton(devState.buttons[i]); }
+  devState.changedButtons.clear();
+  devState.changedAxes.clear();
+  devState.triggeredCount = 0;
+
+  prevAxes = devState.axes;
   for(auto& axis : devState.axes) { axis = 0; }
+}
+
+void Input::Device::endUpdate(uint64_t frameTime, const Input& input) {
+  updateHandler(devState, frameTime);
+
+  //button edges were already forwarded by triggerButton() and releaseButton()
+  if(aggregate) {
+    for(size_t i = 0; i < devState.axes.size(); i++) { aggregate->devState.axes[i] += devState.axes[i]; }
+  }
+
+  for(size_t i : repeatButtons) { updateRepeat(i, frameTime, input); }
+
+  for(size_t i = 0; i < devState.axes.size(); i++) {
+    if(devState.axes[i] != prevAxes[i]) { devState.changedAxes.push_back(i); }
+  }
+}
 
-  updateHandler(devState, eventQueue, frameTime);
+void Input::Device::releaseAll() {
+  for(size_t i = 0; i < devState.buttons.size(); i++) {
+    if(devState.buttons[i].held) { releaseButton(i); }
+  }
+}
 
-  for(size_t i = 0; i < devState.buttons.size(); i++) { updateRepeat(i, frameTime, input); }
+float Input::GamepadDevice::deadZoned(int axis, int input, int axisMaxRange) const {
+  float value = static_cast<float>(input) / axisMaxRange;
+  return std::abs(value) < deadZones[axis] ? 0 : value;
 }
 
-void Input::GamepadDevice::applyDeadZonedInput(DeviceState& devState, int axis, int input, int axisMaxRange) {
-  devState.axes[axis] = static_cast<float>(input) / axisMaxRange;
-  if(abs(devState.axes[axis]) < deadZones[axis]) { devState.axes[axis] = 0; }
+void Input::GamepadDevice::deadZonedAxes(const XINPUT_GAMEPAD& pad, float* axes) const {
+  constexpr int XINPUT_STICK_RANGE = 32768;
+  constexpr int XINPUT_TRIGGER_RANGE = 255;
+  axes[Gamepad::Axes::LEFT_X]   = deadZoned(Gamepad::Axes::LEFT_X,   pad.sThumbLX, XINPUT_STICK_RANGE);
+  axes[Gamepad::Axes::LEFT_Y]   = deadZoned(Gamepad::Axes::LEFT_Y,   pad.sThumbLY, XINPUT_STICK_RANGE);
+  axes[Gamepad::Axes::RIGHT_X]  = deadZoned(Gamepad::Axes::RIGHT_X,  pad.sThumbRX, XINPUT_STICK_RANGE);
+  axes[Gamepad::Axes::RIGHT_Y]  = deadZoned(Gamepad::Axes::RIGHT_Y,  pad.sThumbRY, XINPUT_STICK_RANGE);
+  axes[Gamepad::Axes::LTRIGGER] = deadZoned(Gamepad::Axes::LTRIGGER, pad.bLeftTrigger,  XINPUT_TRIGGER_RANGE);
+  axes[Gamepad::Axes::RTRIGGER] = deadZoned(Gamepad::Axes::RTRIGGER, pad.bRightTrigger, XINPUT_TRIGGER_RANGE);
 }
 
 void Input::Device::triggerButton(size_t index, uint64_t frameTime) {
@@ -77,45 +839,71 @@ void Input::Device::triggerButton(size_t index, uint64_t frameTime) {
   //for some reason RIN observes OS key repeat messages, so we need to ensure that the trigger is not spurious
   if(btn.held) { return; }
 
+  markChanged(index);
+  devState.heldCount++;
+  devState.triggeredCount++;
   btn.triggered = true;
   btn.held      = true;
-  aux.triggerTimeMS = frameTime;
+  btn.repeating = true;
+  btn.repeatCount = 1;
+  aux.triggerTimeNS = frameTime;
   aux.repeatPrev = 0;
+
+  if(telemetry) { telemetry->press(telemetryType, index, frameTime); }
+  if(buffer) { buffer->press(bufferOffset + index, frameTime); }
+  if(aggregate) { aggregate->aggregateTrigger(index, frameTime); }
 }
 
 void Input::Device::releaseButton(size_t index) {
   auto& btn = devState.buttons[index];
+  bool wasHeld = btn.held;
+  markChanged(index);
+  if(wasHeld) { devState.heldCount--; }
   btn.released = true;
   btn.held     = false;
+
+  if(telemetry && wasHeld) { telemetry->release(telemetryType, index); }
+  if(buffer && wasHeld) { buffer->release(bufferOffset + index); }
+  if(aggregate && wasHeld) { aggregate->aggregateRelease(index); }
+}
+
+void Input::Device::aggregateTrigger(size_t index, uint64_t frameTime) {
+  if(holdCounts[index]++ == 0) { triggerButton(index, frameTime); }
+}
+
+void Input::Device::aggregateRelease(size_t index) {
+  if(holdCounts[index] > 0 && --holdCounts[index] == 0) { releaseButton(index); }
+}
+
+void Input::Device::markChanged(size_t index) {
+  //any flag being set means the button was already listed this frame
+  auto& btn = devState.buttons[index];
+  if(!btn.triggered && !btn.released && !btn.repeating) { devState.changedButtons.push_back(index); }
 }
 
 void Input::Device::resetButton(DeviceButton& btn) {
   btn.triggered = false;
   btn.released  = false;
+  btn.repeating = false;
+  btn.repeatCount = 0;
 }
 
 void Input::Device::updateRepeat(size_t index, uint64_t frameTime, const Input& input) {
   DeviceButton& btn = devState.buttons[index];
   ButtonRepeatData& aux = repeatData[index];
 
-  //true on trigger frame
-  btn.repeating = btn.triggered;
-  if(btn.repeating) { return; }
-
-  //if the key isn't down then it's not repeating (unless it triggered)
-  if(!btn.held) { return; }
-
-  //false prior to delay elapsed
-  int elapsedMS = static_cast<int>(frameTime - aux.triggerTimeMS);
-  int postDelayMS = elapsedMS - input.repeatDelayMS;
-  if(postDelayMS < 0) { return; }
+  //the trigger frame already counts as a repeat (see triggerButton()), and if the key
+  //isn't down then it's not repeating
+  if(btn.triggered || !btn.held) { return; }
 
-  //number of repeats that should have happened by now
-  unsigned int repeatTarget = postDelayMS / input.repeatPeriodMS;
-  //if it's increased since the last poll then repeat
-  btn.repeating = aux.repeatPrev < repeatTarget;
+  //every repeat since the last poll fires this frame, so a long frame doesn't swallow any
+  const RepeatProfile& profile = input.repeatProfiles[aux.profile];
+  uint64_t repeatCount = repeatsDue(frameTime - aux.triggerTimeNS, profile.delayNS, profile.periodNS, aux.repeatPrev);
+  if(!repeatCount) { return; }
 
-  aux.repeatPrev = repeatTarget;
+  markChanged(index);
+  btn.repeatCount = static_cast<unsigned int>(repeatCount);
+  btn.repeating = true;
 }
 
 //////////////////////////////////////////////////////////
@@ -129,73 +917,192 @@ Input::MouseDevice::MouseDevice() : Device(BUTTON_CT, AXIS_CT) {
 }
 
 Input::GamepadDevice::GamepadDevice() : Device(BUTTON_CT, AXIS_CT) {
-  buttonPrev.resize(BUTTON_CT);
-  deadZones.resize(AXIS_CT, 0.1f);
+  deadZones.resize(AXIS_CT, DEFAULT_DEAD_ZONE);
 }
 
-void Input::KeyboardDevice::updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) {
-  while(!eventQueue.empty()) {
-    auto event = eventQueue.front().data.keyboard;
+void Input::KeyboardDevice::eventHandler(DeviceState& devState, const RAWINPUT& rin, uint64_t frameTime) {
+  auto& event = rin.data.keyboard;
 
-    if(event.Message == WM_KEYDOWN) { triggerButton(event.VKey, frameTime); }
-    if(event.Message == WM_KEYUP)   { releaseButton(event.VKey); }
+  if(event.Message == WM_KEYDOWN) { triggerButton(event.VKey, frameTime); }
+  if(event.Message == WM_KEYUP)   { releaseButton(event.VKey); }
+}
 
-    eventQueue.pop();
+void Input::MouseDevice::eventHandler(DeviceState& devState, const RAWINPUT& rin, uint64_t frameTime) {
+  auto& event = rin.data.mouse;
+
+  devState.axes[Input::Mouse::DELTA_X] += event.lLastX;
+  devState.axes[Input::Mouse::DELTA_Y] += event.lLastY;
+  devState.axes[Input::Mouse::DELTA_WHEEL] += static_cast<short>(event.usButtonData);
+
+  //Each button has a down bit followed by an up bit, in button order. Most events are motion only, so
+  //only the set bits are visited, which for those is none.
+  constexpr USHORT BUTTON_FLAG_MASK = (1 << (BUTTON_CT * 2)) - 1;
+  unsigned int flags = event.usButtonFlags & BUTTON_FLAG_MASK;
+  while(flags) {
+    unsigned int bit = Utility::lowestSetBit(flags);
+    flags &= flags - 1;
+
+    if(bit & 1) { releaseButton(bit / 2); }
+    else        { triggerButton(bit / 2, frameTime); }
   }
 }
 
-void Input::MouseDevice::updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) {
-  while(!eventQueue.empty()) {
-    auto event = eventQueue.front().data.mouse;
+void Input::GamepadDevice::updateHandler(DeviceState& devState, uint64_t frameTime) {
+  if(!injectedStates.empty()) {
+    for(auto& state : injectedStates) { applyPadState(devState, state.pad, state.timeNS); }
+    injectedStates.clear();
 
-    devState.axes[Input::Mouse::DELTA_X] += event.lLastX;
-    devState.axes[Input::Mouse::DELTA_Y] += event.lLastY;
-    devState.axes[Input::Mouse::DELTA_WHEEL] += static_cast<short>(event.usButtonData);
+    //the poller's queue is stale once synthetic states have been applied over it
+    GamepadPoller::Event discarded;
+    while(poller && poller->pop(discarded)) {}
+    packetValid = false;
+    return;
+  }
 
-    for(size_t i = 0; i < devState.buttons.size(); i++) {
-      USHORT buttonState = event.usButtonFlags >> (i * 2);
-      if(buttonState & 0b01) { triggerButton(i, frameTime); }
-      if(buttonState & 0b10) { releaseButton(i); }
-    }
+  if(poller) {
+    //replay every change since the last update in order, with the time it was sampled
+    GamepadPoller::Event event;
+    while(poller->pop(event)) { applyPadState(devState, event.pad, event.timeNS); }
 
-    eventQueue.pop();
+    //the axes were cleared for the new frame, so restore them even if nothing changed
+    restoreAxes(devState);
+    packetValid = false;
+    return;
+  }
+
+  XINPUT_STATE xstate = {};
+  bool success = connected && XInputGetState(0, &xstate) == ERROR_SUCCESS;
+
+  //the packet number only changes when the pad's state does, so an unchanged pad costs a copy of the axes
+  if(success && packetValid && xstate.dwPacketNumber == lastPacket) {
+    restoreAxes(devState);
+    return;
   }
+
+  //a disconnected pad reads as all zeroes, which releases anything that was held when it was removed
+  if(!success) { xstate = {}; }
+  lastPacket = xstate.dwPacketNumber;
+  packetValid = success;
+  applyPadState(devState, xstate.Gamepad, frameTime);
 }
 
-void Input::GamepadDevice::updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) {
-  if(!eventQueue.empty()) {
-    throw std::runtime_error("XInput device recieved a Raw Input event message. Something is very wrong!");
+void Input::GamepadDevice::applyPadState(DeviceState& devState, const XINPUT_GAMEPAD& pad, uint64_t eventTime) {
+  static_assert(Gamepad::xinputBit(Gamepad::DPAD_UP) == XINPUT_GAMEPAD_DPAD_UP && Gamepad::xinputBit(Gamepad::RSHOULDER) == XINPUT_GAMEPAD_RIGHT_SHOULDER, "Gamepad button order no longer matches XInput");
+  static_assert(Gamepad::xinputBit(Gamepad::A) == XINPUT_GAMEPAD_A && Gamepad::xinputBit(Gamepad::Y) == XINPUT_GAMEPAD_Y, "Gamepad button order no longer matches XInput");
+
+  if(telemetry && std::memcmp(&pad, &lastPad, sizeof(pad)) != 0) { telemetry->countEvent(telemetryType); }
+
+  //The XInput bits are in Gamepad::Buttons order, except for a two bit gap before A. Packing them lets
+  //the edges come from a single XOR, so only the buttons that changed are visited. Several states can be
+  //applied in one frame, since 'heldMask' always matches the live state.
+  uint16_t held = (pad.wButtons & 0x03FF) | ((pad.wButtons >> 2) & 0x3C00);
+  uint16_t changed = held ^ heldMask;
+  while(changed) {
+    unsigned int i = Utility::lowestSetBit(changed);
+    changed &= changed - 1;
+
+    if((held >> i) & 1) { triggerButton(i, eventTime); }
+    else                { releaseButton(i); }
   }
+  heldMask = held;
 
-  XINPUT_STATE xstate;
-  XInputGetState(0, &xstate);
-  auto& pad = xstate.Gamepad;
+  deadZonedAxes(pad, padAxes.data());
+  restoreAxes(devState);
 
-  constexpr int xinBtnMap[] = {
-    XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT,
-    XINPUT_GAMEPAD_START, XINPUT_GAMEPAD_BACK,
-    XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB,
-    XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
-    XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_Y
-  };
+  lastPad = pad;
+}
 
-  for(size_t i = 0; i < devState.buttons.size(); i++) {
-    auto& btn = devState.buttons[i];
+//////////////////////////////////////////////////////////
 
-    btn.held = pad.wButtons & xinBtnMap[i];
+void Input::TextDevice::update() {
+  textState.charCount = ringCount;
+  for(size_t i = 0; i < ringCount; i++) {
+    textState.chars[i] = ring[(ringHead + i) % ring.size()];
+  }
+  textState.overflowed = ringOverflowed;
+
+  ringHead = (ringHead + ringCount) % ring.size();
+  ringCount = 0;
+  ringOverflowed = false;
 
-    if( btn.held && !buttonPrev[i].held) { triggerButton(i, frameTime); }
-    if(!btn.held &&  buttonPrev[i].held) { releaseButton(i); }
+  textState.compositionChanged = compositionDirty;
+  if(compositionDirty) {
+    std::copy(composition.begin(), composition.begin() + compositionLength, textState.composition.begin());
+    textState.compositionLength = compositionLength;
+    textState.composing = composing;
+    compositionDirty = false;
   }
-  
-  constexpr int XINPUT_STICK_RANGE = 32768;
-  constexpr int XINPUT_TRIGGER_RANGE = 255;
-  applyDeadZonedInput(devState, Gamepad::Axes::LEFT_X,   pad.sThumbLX, XINPUT_STICK_RANGE);
-  applyDeadZonedInput(devState, Gamepad::Axes::LEFT_Y,   pad.sThumbLY, XINPUT_STICK_RANGE);
-  applyDeadZonedInput(devState, Gamepad::Axes::RIGHT_X,  pad.sThumbRX, XINPUT_STICK_RANGE);
-  applyDeadZonedInput(devState, Gamepad::Axes::RIGHT_Y,  pad.sThumbRY, XINPUT_STICK_RANGE);
-  applyDeadZonedInput(devState, Gamepad::Axes::LTRIGGER, pad.bLeftTrigger,  XINPUT_TRIGGER_RANGE);
-  applyDeadZonedInput(devState, Gamepad::Axes::RTRIGGER, pad.bRightTrigger, XINPUT_TRIGGER_RANGE);
-
-  buttonPrev = devState.buttons;
+}
+
+void Input::TextDevice::enqueueUnit(wchar_t unit) {
+  if(unit >= 0xD800 && unit <= 0xDBFF) {
+    pendingHighSurrogate = unit;
+    return;
+  }
+
+  if(unit >= 0xDC00 && unit <= 0xDFFF) {
+    //a low surrogate without a preceding high surrogate is malformed, so drop it
+    if(pendingHighSurrogate) {
+      enqueueCodePoint(0x10000 + ((static_cast<char32_t>(pendingHighSurrogate) - 0xD800) << 10) + (unit - 0xDC00));
+    }
+    pendingHighSurrogate = 0;
+    return;
+  }
+
+  pendingHighSurrogate = 0;
+  enqueueCodePoint(unit);
+}
+
+void Input::TextDevice::enqueueByte(char byte) {
+  //on double-byte code pages a character can be a lead byte and a trail byte, which arrive as two messages
+  if(!pendingLeadByte && IsDBCSLeadByte(static_cast<BYTE>(byte))) {
+    pendingLeadByte = byte;
+    return;
+  }
+
+  char bytes[2] = { pendingLeadByte ? pendingLeadByte : byte, byte };
+  int byteCt = pendingLeadByte ? 2 : 1;
+  pendingLeadByte = 0;
+
+  wchar_t unit;
+  if(MultiByteToWideChar(CP_ACP, 0, bytes, byteCt, &unit, 1) == 1) { enqueueUnit(unit); }
+}
+
+void Input::TextDevice::enqueueCodePoint(char32_t codePoint) {
+  if(ringCount == ring.size()) {
+    ringOverflowed = true;
+    return;
+  }
+
+  ring[(ringHead + ringCount) % ring.size()] = codePoint;
+  ringCount++;
+}
+
+void Input::TextDevice::beginComposition() {
+  composing = true;
+  compositionLength = 0;
+  compositionDirty = true;
+}
+
+void Input::TextDevice::setComposition(const wchar_t* units, size_t unitCt) {
+  //decode into the fixed composition buffer, truncating anything that doesn't fit
+  compositionLength = 0;
+  for(size_t i = 0; i < unitCt && compositionLength < composition.size(); i++) {
+    char32_t codePoint = units[i];
+    bool isHigh = units[i] >= 0xD800 && units[i] <= 0xDBFF;
+    if(isHigh && i + 1 < unitCt && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+      i++;
+    }
+    composition[compositionLength++] = codePoint;
+  }
+
+  composing = true;
+  compositionDirty = true;
+}
+
+void Input::TextDevice::endComposition() {
+  composing = false;
+  compositionLength = 0;
+  compositionDirty = true;
 }
@@ -3,12 +3,33 @@
 #include <vector>
 #include <chrono>
 #include <queue>
+#include <array>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <bitset>
+#include <limits>
 #include "cl_Window.h"
+#include "cl_DeviceWatcher.h"
+#include "cl_GamepadPoller.h"
+#include "st_InputFrame.h"
+#include "cl_InputHistory.h"
+#include "cl_InputBuffer.h"
+#include "cl_InputConfigWatcher.h"
+
+class InputTelemetry;
+class InputDigest;
 
 class Input {
 public:
   Input(Window& win);
+  //Headless - no window and no device detection (see watchDevices()), so only injected input arrives (see injectEvent()).
+  //For tools that replay recorded input through the same device logic as the game.
+  Input();
+  ~Input();
   void update();
+  //updates as of 'frameTimeNS' (steady_clock nanoseconds) instead of now, for replays - it must not go backwards
+  void update(uint64_t frameTimeNS);
 
   struct DeviceButton {
     //'held' is true if the button is currently pressed down
@@ -22,26 +43,59 @@ public:
 
     //'repeating' is true in the following cases:
     //  * if 'trigger' is true
-    //  * one frame every 'repeatPeriodMS' AFTER the button has been held for at least 'repeatDelayMS'
+    //  * one frame every 'periodMS' AFTER the button has been held for at least 'delayMS'
+    //The delay and period come from the button's repeat profile (see Input::setRepeatProfile()).
+    //Buttons assigned NEVER_REPEAT are only 'repeating' on their trigger frame.
     //This is useful for things like menu navigation, where the player will want precise movement from
     //pressing the button once, but may also want to hold the button in order to scroll quickly.
     bool repeating = false;
+
+    //'repeatCount' is the number of repeats that fired during this frame (1 on the trigger frame)
+    //A long frame may span several repeat periods, in which case each of them is counted here so that
+    //scrolling can advance by the correct amount rather than losing the extra repeats.
+    unsigned int repeatCount = 0;
   };
 
+  enum class DeviceType { KEYBOARD, MOUSE, GAMEPAD };
+
   struct DeviceState {
     std::vector<DeviceButton> buttons;
     std::vector<float> axes;
+
+    //Indices of the buttons that triggered, released or repeated during this frame, each listed once.
+    //Use this instead of scanning 'buttons' when looking for what happened this frame.
+    std::vector<size_t> changedButtons;
+
+    //indices of the axes whose value differs from the previous frame
+    std::vector<size_t> changedAxes;
+
+    size_t heldCount = 0;
+    size_t triggeredCount = 0;
+    bool anyHeld() const { return heldCount > 0; }
+    bool anyTriggered() const { return triggeredCount > 0; }
   };
 
   struct Mouse {
     enum Axes    { DELTA_X, DELTA_Y, DELTA_WHEEL };
     enum Buttons { L_BUTTON, R_BUTTON, WHEEL_BUTTON, BACK, FORWARD };
   };
+  //merged state of every connected mouse
   const DeviceState& mouse() const { return mouseDev.state(); }
 
-  //presently indexed by winapi VK codes
+  //merged state of every connected keyboard, presently indexed by winapi VK codes
   const DeviceState& keyboard() const { return kbDev.state(); }
 
+  //Each physical keyboard and mouse also has its own state, identified by its raw input device handle.
+  //This allows for things like local multiplayer with one mouse per player. The merged keyboard() and
+  //mouse() states treat a button as held while it is held on any of the physical devices.
+  typedef HANDLE DeviceID;
+
+  //IDs of the physical keyboards or mice that are currently known (only KEYBOARD and MOUSE are valid)
+  const std::vector<DeviceID>& physicalDevices(DeviceType type) const;
+
+  //throws if 'id' is not a known physical device
+  const DeviceState& physicalDevice(DeviceID id) const;
+
   struct Gamepad {
     enum Axes    {
       LEFT_X, LEFT_Y,
@@ -55,52 +109,402 @@ public:
       LSHOULDER, RSHOULDER,
       A, B, X, Y
     };
+    //the XINPUT_GAMEPAD::wButtons bit of a button - XInput has them in the same order, but with a two bit gap before A
+    static constexpr WORD xinputBit(size_t button) { return static_cast<WORD>(1 << (button < A ? button : button + 2)); }
   };
+  //Typed text is delivered as UTF-32 code points in the order they were typed. Control characters
+  //such as backspace (U+0008) and carriage return (U+000D) are included so that text fields can
+  //handle editing. This is independent of the keyboard() state, which only knows about keys.
+  static constexpr size_t TEXT_CAPACITY = 256;
+  static constexpr size_t COMPOSITION_CAPACITY = 64;
+  struct TextState {
+    //code points typed during this frame
+    std::array<char32_t, TEXT_CAPACITY> chars;
+    size_t charCount = 0;
+
+    //'overflowed' is true if more than TEXT_CAPACITY code points arrived during this frame (the excess is lost)
+    bool overflowed = false;
+
+    //the in-progress IME composition string - this is not part of 'chars' until the IME commits it
+    std::array<char32_t, COMPOSITION_CAPACITY> composition;
+    size_t compositionLength = 0;
+
+    //'composing' is true while an IME composition is open
+    bool composing = false;
+
+    //'compositionChanged' is true if the composition string changed, began or ended during this frame
+    bool compositionChanged = false;
+  };
+  const TextState& text() const { return textDev.state(); }
+
+  //Devices are detected on a background thread (see DeviceWatcher) and take effect on the next update().
+  typedef DeviceWatcher::DeviceDesc DeviceDesc;
+  typedef DeviceWatcher::Change DeviceChange;
+
+  //Replaces the device watcher, which is meant to happen before the first update(). A window's Input starts
+  //with one that asks the OS, and a headless one has none, so this is how a test supplies its own devices.
+  void watchDevices(std::unique_ptr<DeviceWatcher> watcher);
+
+  //devices that arrived or were removed during this frame
+  const std::vector<DeviceChange>& deviceChanges() const { return deviceChangeList; }
+
+  //all currently connected devices
+  const std::vector<DeviceDesc>& connectedDevices() const { return connectedDeviceList; }
+
+  //'gamepadConnected' is true while the XInput pad in slot 0 is connected
+  bool gamepadConnected() const { return xinputDev.connected; }
+
+  //By default the pad is sampled once per update(), so a button tapped and released between two updates
+  //is never seen. Polling samples it on a background thread at 'pollHz' instead, and update() applies
+  //every change in order - a short tap then shows up as 'triggered' and 'released' in the same frame.
+  void enableGamepadPolling(unsigned int pollHz);
+  void disableGamepadPolling();
+
+  //every axis starts out with this dead zone radius
+  static constexpr float DEFAULT_DEAD_ZONE = 0.1f;
   float getGamepadDeadZone(int axis);
   void setGamepadDeadZone(int axis, float zoneRadius);
   const DeviceState& gamepad() const { return xinputDev.state(); }
 
-  //the user may change these values to customize the DeviceButton repeat behavior
-  unsigned int getRepeatDelayMS() const { return repeatDelayMS; }
-  void getRepeatDelayMS(unsigned int milliseconds) { repeatDelayMS = milliseconds; }
-
-  unsigned int getRepeatPeriodMS() const { return repeatPeriodMS; }
-  void getRepeatPeriodMS(unsigned int milliseconds) { repeatPeriodMS = milliseconds; }
+  //the merged state of any of the three devices
+  const DeviceState& state(DeviceType type) const { return device(type).state(); }
+
+  //Every button and axis also has a place in the InputFrame layout, which everything that works on whole
+  //frames (layers, buffers, telemetry, digests) shares. controlBit() doesn't check 'button', whereas
+  //axisIndex() throws for an axis the device doesn't have.
+  static size_t controlBit(DeviceType device, size_t button);
+  static size_t axisIndex(DeviceType device, size_t axis);
+
+  //The merged buttons that are held, that triggered and that were released during this frame, as words in
+  //the InputFrame bit layout, so that sets of buttons can be tested with a few ANDs. deviceMask() has the
+  //bits of one device.
+  typedef std::array<uint64_t, InputFrame::BUTTON_WORD_CT> ButtonWords;
+  const ButtonWords& heldWords() const { return heldBits; }
+  const ButtonWords& triggeredWords() const { return triggeredBits; }
+  const ButtonWords& releasedWords() const { return releasedBits; }
+  static const ButtonWords& deviceMask(DeviceType device);
+
+  //Mid-frame peeks at the freshest motion, for late-latching things like the camera just before present.
+  //Nothing is consumed - the next update() still reports everything, so the DeviceState edges stay
+  //consistent for the whole frame.
+  //peekMouse() is the merged motion received since the last update() (indexed by Mouse::Axes). Motion
+  //only arrives while messages are pumped, so pump the window (Window::update()) right before peeking.
+  std::array<float, InputFrame::MOUSE_AXIS_CT> peekMouse() const { return pendingMouseMotion; }
+  //peekGamepad() samples the pad now and returns its dead-zoned axes (indexed by Gamepad::Axes)
+  std::array<float, InputFrame::GAMEPAD_AXIS_CT> peekGamepad() const;
+
+  //Synthetic input, for load generators and replays. injectEvent() routes a raw input event exactly like
+  //a WM_INPUT message would. Injected gamepad states are applied in order on the next update(), in place
+  //of sampling the pad for that frame.
+  void injectEvent(const RAWINPUT& event);
+  void injectGamepadState(const XINPUT_GAMEPAD& pad, uint64_t timeNS);
+
+  //the deepest any device's event queue has been since the last reset
+  size_t eventQueueHighWater() const;
+  void resetEventQueueHighWater();
+
+  //number of updates so far - captured frames are stamped with this
+  uint32_t frameNumber() const { return frameCounter; }
+
+  //when the last update() happened, in steady_clock nanoseconds
+  uint64_t frameTimeNS() const { return lastFrameTime; }
+
+  //packs the merged keyboard, mouse and gamepad state into 'frame' (see InputFrame and InputCodec)
+  void captureFrame(InputFrame& frame) const;
+
+  //Once enabled, every update() captures a frame into a history of the given capacity (see InputHistory).
+  //Enabling again replaces the history. history() is null until enabled.
+  InputHistory& enableHistory(size_t capacity);
+  InputHistory* history() { return frameHistory.get(); }
+  const InputHistory* history() const { return frameHistory.get(); }
+
+  //Telemetry counts presses, hold durations, press intervals and event rates (see InputTelemetry).
+  //It is off until enabled, and enabling it again starts the counts over. telemetry() is null while disabled.
+  InputTelemetry& enableTelemetry();
+  void disableTelemetry();
+  InputTelemetry* telemetry() { return telemetryData.get(); }
+
+  //The digest keeps a hash of the captured frame up to date (see InputDigest), for lockstep peers to
+  //compare along with frameNumber(). It costs a few operations per changed control. Enabling it again
+  //starts it over from the current frame, and digest() is null while disabled.
+  InputDigest& enableDigest();
+  void disableDigest();
+  const InputDigest* digest() const { return inputDigest.get(); }
+
+  //Buffered presses, for things like jump buffering and parry windows (see InputBuffer). The newest few
+  //presses and releases of every button are kept with a consumed marker, and each query is O(1).
+  //pressedWithin() is true if the button's newest press came at most 'ms' before this frame and hasn't
+  //been consumed yet. consumePress() consumes it (and any before it) and returns false if there was none.
+  bool pressedWithin(DeviceType device, size_t button, unsigned int ms) const;
+  bool releasedWithin(DeviceType device, size_t button, unsigned int ms) const;
+  bool consumePress(DeviceType device, size_t button);
+  const InputBuffer& buffer() const { return pressBuffer; }
+
+  //Repeat profiles control the DeviceButton repeat behavior of individual buttons.
+  //Every button starts out on DEFAULT_REPEAT. Profiles are meant to be set up at configuration time;
+  //assigning a profile is O(buttons) for the affected device, whereas the per-frame repeat pass only
+  //visits buttons that are not assigned NEVER_REPEAT.
+  //A held button starts its delay over when it is assigned a profile or its profile's timing changes.
+  typedef uint8_t RepeatProfileID;
+  static constexpr RepeatProfileID NEVER_REPEAT   = 0;
+  static constexpr RepeatProfileID DEFAULT_REPEAT = 1;
+
+  //returns the ID of the new profile - throws if the profile table is full
+  RepeatProfileID addRepeatProfile(unsigned int delayMS, unsigned int periodMS);
+  void setRepeatProfile(DeviceType device, size_t button, RepeatProfileID profile);
+  RepeatProfileID getRepeatProfile(DeviceType device, size_t button) const;
+
+  //the user may change these values to customize the DEFAULT_REPEAT profile
+  static constexpr unsigned int DEFAULT_REPEAT_DELAY_MS  = 500;
+  static constexpr unsigned int DEFAULT_REPEAT_PERIOD_MS = 100;
+  unsigned int getRepeatDelayMS() const;
+  void setRepeatDelayMS(unsigned int milliseconds);
+
+  unsigned int getRepeatPeriodMS() const;
+  void setRepeatPeriodMS(unsigned int milliseconds);
+
+  //The repeat timing shared with VirtualControllers: how many repeats past the trigger frame came due by
+  //'elapsedNS' after the trigger that 'fired' doesn't already count, advancing 'fired' to include them.
+  //Nothing fires before the repeat after the ones already fired is due. Lengthening the delay or period
+  //while a button is held can put that further off than it was, but never fires a burst. Held buttons
+  //that aren't due only cost a multiply and a compare.
+  static uint64_t repeatsDue(uint64_t elapsedNS, uint64_t delayNS, uint64_t periodNS, uint64_t& fired) {
+    if(elapsedNS < delayNS || elapsedNS - delayNS < (fired + 1) * periodNS) { return 0; }
+    uint64_t target = (elapsedNS - delayNS) / periodNS;
+    uint64_t due = target - fired;
+    fired = target;
+    return due;
+  }
+
+  //Bindings, dead zones and repeat profiles can come from a configuration file (see InputConfig for the
+  //format). The file is watched and parsed on a background thread (see InputConfigWatcher), and each valid
+  //version is swapped in at the start of the next update(), so every frame sees one whole configuration
+  //and the game thread never parses, allocates or waits during a reload. A configuration replaces the
+  //dead zones, repeat profiles and profile assignments made through the setters above, and held buttons
+  //whose profile or profile timing changed start their repeat delay over. Invalid versions are skipped (see configStatus()).
+  void watchConfig(const std::string& path);
+  //the configuration that is in place stays there
+  void stopWatchingConfig();
+  InputConfigWatcher::Status configStatus() const;
+
+  //applies 'config' right away, for configurations built at startup (throws if it is null)
+  void setConfig(std::unique_ptr<const InputConfig> config);
+
+  //the configuration in place, null until one has loaded
+  const InputConfig* config() const { return activeConfig.get(); }
+
+  //An action is held, triggered or released this frame if any of its bound buttons is. Unbound actions
+  //(and every action before a configuration loads) are none of these.
+  typedef InputConfig::ActionID ActionID;
+  bool actionHeld(ActionID action) const      { return actionFlag(action, &DeviceButton::held); }
+  bool actionTriggered(ActionID action) const { return actionFlag(action, &DeviceButton::triggered); }
+  bool actionReleased(ActionID action) const  { return actionFlag(action, &DeviceButton::released); }
+  bool actionRepeating(ActionID action) const { return actionFlag(action, &DeviceButton::repeating); }
+
+  //Subscriptions are an alternative to polling the states: update() calls back when a control changes.
+  //Dispatch only visits the controls listed in changedButtons/changedAxes, so controls that nobody
+  //subscribed to cost nothing. Callbacks may subscribe and unsubscribe - an unsubscribed callback is not
+  //called again, and new subscriptions take effect from the next update(). An exception thrown by a
+  //callback propagates out of update() and skips the rest of that frame's callbacks, but the subscription
+  //changes made before it still take effect.
+  enum class ButtonEvent { TRIGGERED, RELEASED, REPEATED };
+  typedef uint32_t SubscriptionID;
+  typedef std::function<void(const DeviceButton&)> ButtonCallback;
+  typedef std::function<void(float)> AxisCallback;
+
+  //REPEATED follows DeviceButton::repeating, so it also fires on the trigger frame
+  SubscriptionID subscribe(DeviceType device, size_t button, ButtonEvent event, ButtonCallback callback);
+
+  //'callback' receives the axis value whenever it has moved at least 'threshold' from the last value reported
+  SubscriptionID subscribeAxis(DeviceType device, size_t axis, float threshold, AxisCallback callback);
+
+  //'callback' is called at the end of every update(), after the control subscribers
+  SubscriptionID subscribeFrame(std::function<void()> callback);
+
+  //unknown IDs are ignored
+  void unsubscribe(SubscriptionID id);
 
 private:
-  static const unsigned int DEFAULT_REPEAT_DELAY_MS  = 500;
-  static const unsigned int DEFAULT_REPEAT_PERIOD_MS = 100;
-  unsigned int repeatDelayMS;
-  unsigned int repeatPeriodMS;
+  struct RepeatProfile {
+    uint64_t delayNS;
+    uint64_t periodNS;
+  };
+  //indexed by RepeatProfileID
+  std::vector<RepeatProfile> repeatProfiles;
+  //restarts the repeat timing of held buttons on 'profile' after its timing changes
+  void restartRepeats(RepeatProfileID profile);
+  //one flag per possible RepeatProfileID
+  typedef std::bitset<static_cast<size_t>(std::numeric_limits<RepeatProfileID>::max()) + 1> RepeatProfileSet;
+
+  uint32_t frameCounter = 0;
+  uint64_t lastFrameTime = 0;
+  std::unique_ptr<InputTelemetry> telemetryData;
+  std::unique_ptr<InputHistory> frameHistory;
+  std::unique_ptr<InputDigest> inputDigest;
+  InputFrame historyScratch;
+  InputBuffer pressBuffer;
+
+  ButtonWords heldBits = {};
+  ButtonWords triggeredBits = {};
+  ButtonWords releasedBits = {};
+  //brings the words up to date from the buttons that changed during this frame
+  void updateButtonWords();
+
+  //the merged button behind an InputFrame button bit
+  const DeviceButton& controlButton(size_t control) const;
+
+  std::unique_ptr<InputConfigWatcher> configWatcher;
+  std::unique_ptr<const InputConfig> activeConfig;
+  void applyConfig(const InputConfig& config, uint64_t frameTime);
+  bool actionFlag(ActionID action, bool DeviceButton::*flag) const;
+
+  struct ButtonSubscriber {
+    SubscriptionID id;
+    ButtonEvent event;
+    ButtonCallback callback;
+  };
+  struct AxisSubscriber {
+    SubscriptionID id;
+    float threshold;
+    float lastValue;
+    AxisCallback callback;
+  };
+
+  //Subscribers are kept in one flat array grouped by control, so a control's subscribers are contiguous.
+  //Control i's subscribers are entries[first[i]] up to entries[first[i + 1]].
+  template<typename Entry>
+  struct SubscriberTable {
+    std::vector<Entry> entries;
+    std::vector<uint32_t> first;
+
+    void resize(size_t controlCt) { first.assign(controlCt + 1, 0); }
+    size_t controlCount() const { return first.size() - 1; }
+
+    void insert(size_t control, Entry entry) {
+      entries.insert(entries.begin() + first[control + 1], std::move(entry));
+      for(size_t i = control + 1; i < first.size(); i++) { first[i]++; }
+    }
+
+    Entry* find(SubscriptionID id) {
+      for(auto& entry : entries) {
+        if(entry.id == id) { return &entry; }
+      }
+      return nullptr;
+    }
+
+    bool erase(SubscriptionID id) {
+      Entry* entry = find(id);
+      if(!entry) { return false; }
+      size_t index = entry - entries.data();
+      entries.erase(entries.begin() + index);
+      for(auto& offset : first) {
+        if(offset > index) { offset--; }
+      }
+      return true;
+    }
+  };
+
+  struct FrameSubscriber {
+    SubscriptionID id;
+    std::function<void()> callback;
+  };
+
+  struct DeviceSubscribers {
+    SubscriberTable<ButtonSubscriber> buttons;
+    SubscriberTable<AxisSubscriber> axes;
+  };
+  //indexed by DeviceType
+  std::array<DeviceSubscribers, 3> subscribers;
+  std::vector<FrameSubscriber> frameSubscribers;
+  //entries unsubscribed during dispatch are marked with this ID and erased once it ends
+  static constexpr SubscriptionID UNSUBSCRIBED = 0;
+  SubscriptionID nextSubscriptionID = 1;
+
+  //Subscribing during dispatch would move the entries being walked, so it is deferred until dispatch ends.
+  bool dispatchingSubscribers = false;
+  std::vector<std::function<void()>> deferredSubscriberChanges;
+  void dispatchSubscribers();
+  void eraseFrameSubscriber(SubscriptionID id);
 
 
   class Device {
   public:
     Device(size_t buttonCt, size_t axisCt);
-
+    virtual ~Device() = default;
+
+    //A frame is processed by calling beginUpdate(), then handleEvent() for each of the frame's events,
+    //then endUpdate(). update() is the same thing for devices that don't receive events.
+    //'frameTime' is in nanoseconds from a monotonic clock
+    void beginUpdate();
+    void handleEvent(const RAWINPUT& event, uint64_t frameTime) { eventHandler(devState, event, frameTime); }
+    void endUpdate(uint64_t frameTime, const Input& input);
     void update(uint64_t frameTime, const Input& input);
     const DeviceState& state() const { return devState; }
 
-    void enqueueEvent(const RAWINPUT& event) { eventQueue.push(event); }
+    //An aggregate device receives the button edges and axis values of the devices that feed it
+    //instead of handling events itself. Its beginUpdate() has to come before theirs and its
+    //endUpdate() after theirs.
+    void setAggregate(Device* aggregateDevice) { aggregate = aggregateDevice; }
+
+    //button edges are reported to 'telemetry' as belonging to 'type' (null turns reporting off)
+    void setTelemetry(InputTelemetry* telemetry, DeviceType type) { this->telemetry = telemetry; telemetryType = type; }
+
+    //button edges are recorded in 'buffer', with button i as control 'controlOffset' + i (see InputBuffer)
+    void setBuffer(InputBuffer* buffer, size_t controlOffset) { this->buffer = buffer; bufferOffset = controlOffset; }
+
+    //releases every held button (used when the device is removed)
+    void releaseAll();
+
+    //Held buttons whose profile is assigned or edited start their delay over at 'frameTime', since the
+    //repeats they have fired so far were counted against the old timing.
+    void setRepeatProfile(size_t index, RepeatProfileID profile, uint64_t frameTime);
+    //Sets every button's profile at once without allocating. Only the held buttons whose profile ID
+    //changes, or whose profile is in 'retimed', start their delay over.
+    void setRepeatProfiles(const RepeatProfileID* profiles, const RepeatProfileSet& retimed, uint64_t frameTime);
+    //for when the timing of 'profile' changes
+    void restartRepeats(RepeatProfileID profile, uint64_t frameTime);
+    RepeatProfileID getRepeatProfile(size_t index) const { return repeatData[index].profile; }
+    void copyRepeatProfiles(const Device& other);
 
   protected:
     void triggerButton(size_t index, uint64_t frameTime);
     void releaseButton(size_t index);
 
+    InputTelemetry* telemetry = nullptr;
+    DeviceType telemetryType = DeviceType::KEYBOARD;
+    InputBuffer* buffer = nullptr;
+    size_t bufferOffset = 0;
+
   private:
     struct ButtonRepeatData {
-      uint64_t triggerTimeMS;
-      unsigned int repeatPrev;
+      uint64_t triggerTimeNS;
+      uint64_t repeatPrev;
+      RepeatProfileID profile;
     };
 
     DeviceState devState;
     std::vector<ButtonRepeatData> repeatData;
-    std::queue<RAWINPUT> eventQueue;
+    //indices of the buttons whose profile is not NEVER_REPEAT
+    std::vector<size_t> repeatButtons;
+
+    Device* aggregate = nullptr;
+    //aggregate devices only - the number of feeding devices that hold each button
+    std::vector<uint16_t> holdCounts;
+    void aggregateTrigger(size_t index, uint64_t frameTime);
+    void aggregateRelease(size_t index);
+
+    std::vector<float> prevAxes;
 
     void resetButton(DeviceButton& btn);
+    void markChanged(size_t index);
     void updateRepeat(size_t index, uint64_t frameTime, const Input& input);
+    void restartRepeat(size_t index, uint64_t frameTime);
+
+    //handles a single raw input event
+    virtual void eventHandler(DeviceState& devState, const RAWINPUT& event, uint64_t frameTime) {}
 
-    virtual void updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) = 0;
+    //called once per frame after the events, for devices that poll
+    virtual void updateHandler(DeviceState& devState, uint64_t frameTime) {}
 
   };
 
@@ -111,7 +515,7 @@ private:
     KeyboardDevice();
 
   private:
-    void updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) override;
+    void eventHandler(DeviceState& devState, const RAWINPUT& event, uint64_t frameTime) override;
 
   };
 
@@ -122,7 +526,7 @@ private:
     MouseDevice();
 
   private:
-    void updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) override;
+    void eventHandler(DeviceState& devState, const RAWINPUT& event, uint64_t frameTime) override;
 
   };
 
@@ -134,17 +538,115 @@ private:
 
     std::vector<float> deadZones;
 
+    //while this is false the pad is not polled and reads as released/centered
+    bool connected = false;
+
+    //when set, state changes come from the poller instead of sampling the pad during the update
+    std::unique_ptr<GamepadPoller> poller;
+
+    //see Input::injectGamepadState()
+    std::vector<GamepadPoller::Event> injectedStates;
+
+    //fills 'axes' (indexed by Gamepad::Axes) with the dead-zoned axis values of 'pad'
+    void deadZonedAxes(const XINPUT_GAMEPAD& pad, float* axes) const;
+
+    //recomputes the current axes after a dead zone change, which would otherwise wait for the pad's state to change
+    void refreshAxes() { deadZonedAxes(lastPad, padAxes.data()); }
+
   private:
-    void updateHandler(DeviceState& devState, std::queue<RAWINPUT>& eventQueue, uint64_t frameTime) override;
-    void applyDeadZonedInput(DeviceState& devState, int axis, int input, int axisMaxRange);
-    std::vector<DeviceButton> buttonPrev;
+    void updateHandler(DeviceState& devState, uint64_t frameTime) override;
+    void applyPadState(DeviceState& devState, const XINPUT_GAMEPAD& pad, uint64_t eventTime);
+    void restoreAxes(DeviceState& devState) const { std::copy(padAxes.begin(), padAxes.end(), devState.axes.begin()); }
+    float deadZoned(int axis, int input, int axisMaxRange) const;
+
+    //the most recently applied state, so that axes persist through frames with no poller events
+    XINPUT_GAMEPAD lastPad = {};
+    std::array<float, AXIS_CT> padAxes = {};
+
+    //held buttons of the applied state, one bit per button in Gamepad::Buttons order
+    uint16_t heldMask = 0;
+
+    //the packet number of the last sampled state, valid while sampling the pad directly
+    DWORD lastPacket = 0;
+    bool packetValid = false;
+
+  };
+
+  //Receives WM_CHAR and IME messages into a fixed ring that is drained into TextState once per frame.
+  //Nothing here allocates, so text entry costs nothing beyond the copy.
+  class TextDevice {
+  public:
+    void update();
+    const TextState& state() const { return textState; }
+
+    //accepts UTF-16 code units, pairing up surrogates
+    void enqueueUnit(wchar_t unit);
+    //accepts bytes in the active code page, pairing up double-byte characters
+    void enqueueByte(char byte);
+    void enqueueCodePoint(char32_t codePoint);
+    //for text that was lost before it reached the ring
+    void markOverflowed() { ringOverflowed = true; }
+
+    void beginComposition();
+    void setComposition(const wchar_t* units, size_t unitCt);
+    void endComposition();
+
+  private:
+    std::array<char32_t, TEXT_CAPACITY> ring;
+    size_t ringHead = 0;
+    size_t ringCount = 0;
+    bool ringOverflowed = false;
+    wchar_t pendingHighSurrogate = 0;
+    char pendingLeadByte = 0;
+
+    std::array<char32_t, COMPOSITION_CAPACITY> composition;
+    size_t compositionLength = 0;
+    bool composing = false;
+    bool compositionDirty = false;
+
+    TextState textState;
 
   };
 
   KeyboardDevice kbDev;
   MouseDevice mouseDev;
   GamepadDevice xinputDev;
+  TextDevice textDev;
 
+  struct PhysicalDevice {
+    DeviceType type;
+    DeviceID id;
+    std::unique_ptr<Device> device;
+  };
+  //the map gives O(1) routing from raw input handle to slot in 'physicalDeviceList'
+  std::unordered_map<DeviceID, size_t> physicalSlots;
+  std::vector<PhysicalDevice> physicalDeviceList;
+  std::vector<DeviceID> physicalKeyboardIDs;
+  std::vector<DeviceID> physicalMouseIDs;
+  Device& physicalDevice(DeviceID id, DeviceType type);
+  void retirePhysicalDevice(DeviceID id);
+
+  //null for headless inputs
+  std::unique_ptr<DeviceWatcher> deviceWatcher;
+  std::vector<DeviceChange> deviceChangeList;
+  std::vector<DeviceDesc> connectedDeviceList;
+  void applyDeviceChanges();
+
+  Device& device(DeviceType type);
+  const Device& device(DeviceType type) const;
+
+  //Keyboard and mouse events from every physical device share one queue, so that they are applied in the
+  //order they arrived - otherwise the merged states could see one device's release before another
+  //device's earlier press.
+  std::queue<RAWINPUT> eventQueue;
+  //the merged mouse motion sitting in 'eventQueue' (see peekMouse())
+  std::array<float, InputFrame::MOUSE_AXIS_CT> pendingMouseMotion = {};
+  size_t eventQueueMax = 0;
+  void routeEvent(const RAWINPUT& rin);
+  void dispatchEvents(uint64_t frameTime);
   LRESULT procFn(HWND hwnd, WPARAM wparam, LPARAM lparam);
+  LRESULT deviceChangeProcFn(HWND hwnd, WPARAM wparam, LPARAM lparam);
+  LRESULT charProcFn(HWND hwnd, WPARAM wparam, LPARAM lparam);
+  LRESULT imeProcFn(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
 
 };
@@ -0,0 +1,239 @@
+#include "cl_InputAnalyzer.h"
+#include "cl_InputCodec.h"
+#include "ns_Utility.h"
+#include <Xinput.h>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+  //replay time starts here rather than at zero, which Input treats as never having updated
+  constexpr uint64_t START_TIME_NS = 1000000000;
+
+  //streams are read through a buffer this big
+  constexpr size_t READ_BUFFER_SIZE = 1 << 16;
+}
+
+const HANDLE InputAnalyzer::KEYBOARD_HANDLE = reinterpret_cast<HANDLE>(0xA7A10001);
+const HANDLE InputAnalyzer::MOUSE_HANDLE    = reinterpret_cast<HANDLE>(0xA7A10002);
+
+InputAnalyzer::Totals::Totals() {
+  controls.fill(ControlTotals{ 0, Histogram{}, Histogram{}, 0 });
+}
+
+void InputAnalyzer::Totals::merge(const Totals& other) {
+  sessions += other.sessions;
+  frames += other.frames;
+  seconds += other.seconds;
+  for(size_t i = 0; i < edges.size(); i++) {
+    edges[i] += other.edges[i];
+    activeFrames[i] += other.activeFrames[i];
+  }
+
+  for(size_t i = 0; i < controls.size(); i++) {
+    auto& control = controls[i];
+    auto& otherControl = other.controls[i];
+    control.presses += otherControl.presses;
+    control.repeats += otherControl.repeats;
+    for(size_t b = 0; b < InputTelemetry::BUCKET_CT; b++) {
+      control.holdDurations[b] += otherControl.holdDurations[b];
+      control.pressIntervals[b] += otherControl.pressIntervals[b];
+    }
+  }
+
+  failures.insert(failures.end(), other.failures.begin(), other.failures.end());
+}
+
+InputAnalyzer::InputAnalyzer(double framePeriodMS) : framePeriodNS(static_cast<uint64_t>(std::llround(framePeriodMS * Utility::NS_PER_MS))) {
+  if(framePeriodNS == 0) { throw std::runtime_error("Recording frame period must be positive."); }
+}
+
+bool InputAnalyzer::analyze(std::istream& recording, Totals& totals) const {
+  //the recorded axes are already dead-zoned, so applying the dead zones again would only distort them
+  Input input;
+  for(int axis = 0; axis < static_cast<int>(InputFrame::GAMEPAD_AXIS_CT); axis++) { input.setGamepadDeadZone(axis, 0); }
+  InputTelemetry& telemetry = input.enableTelemetry();
+
+  //the keyframe is a delta against the all-released frame
+  InputFrame previous;
+  InputFrame frame;
+  bool keyframe = true;
+  bool valid = true;
+  uint64_t timeNS = START_TIME_NS;
+  uint64_t frames = 0;
+  uint8_t packet[InputCodec::MAX_ENCODED_SIZE];
+
+  while(true) {
+    uint8_t prefix[2];
+    if(!recording.read(reinterpret_cast<char*>(prefix), sizeof(prefix))) {
+      //anything other than a clean end between packets is a truncated recording
+      valid = recording.gcount() == 0;
+      break;
+    }
+
+    size_t size = prefix[0] | (prefix[1] << 8);
+    if(size == 0 || size > sizeof(packet) || !recording.read(reinterpret_cast<char*>(packet), size) ||
+      !InputCodec::decode(packet, size, keyframe ? nullptr : &previous, frame)) {
+      valid = false;
+      break;
+    }
+
+    if(!keyframe) {
+      //The exporter skips frames that are the same as the one before, so the gap is made up of copies of
+      //'previous'. Mouse motion repeats in every one of them, but otherwise a single update at the end of
+      //the gap will do - it fires every repeat that came due during the gap (see DeviceButton::repeatCount).
+      uint32_t skipped = frame.frameNumber - previous.frameNumber - 1;
+      bool moving = false;
+      for(size_t i = 0; i < InputFrame::MOUSE_AXIS_CT; i++) { moving |= previous.axes[InputFrame::MOUSE_AXIS_OFFSET + i] != 0; }
+
+      if(moving) {
+        for(uint32_t i = 0; i < skipped; i++) {
+          timeNS += framePeriodNS;
+          replayFrame(input, previous, previous, timeNS, totals);
+        }
+      }
+      else if(skipped > 0) {
+        timeNS += skipped * framePeriodNS;
+        replayFrame(input, previous, previous, timeNS, totals);
+      }
+      frames += skipped;
+    }
+
+    timeNS += framePeriodNS;
+    replayFrame(input, previous, frame, timeNS, totals);
+    frames++;
+
+    previous = frame;
+    keyframe = false;
+  }
+
+  InputTelemetry::Snapshot snapshot;
+  telemetry.snapshot(snapshot);
+
+  totals.sessions++;
+  totals.frames += frames;
+  totals.seconds += frames * framePeriodNS / 1e9;
+
+  for(size_t i = 0; i < totals.controls.size(); i++) {
+    auto& control = totals.controls[i];
+    auto& stats = snapshot.controls[i];
+    control.presses += stats.presses;
+    for(size_t b = 0; b < InputTelemetry::BUCKET_CT; b++) {
+      control.holdDurations[b] += stats.holdDurations[b];
+      control.pressIntervals[b] += stats.pressIntervals[b];
+    }
+  }
+
+  return valid;
+}
+
+InputAnalyzer::Totals InputAnalyzer::analyzeFiles(const std::vector<std::string>& paths, unsigned int threadCount) const {
+  threadCount = (std::max)(1u, (std::min)(threadCount, static_cast<unsigned int>(paths.size())));
+
+  std::atomic<size_t> nextPath{ 0 };
+  std::vector<Totals> threadTotals(threadCount);
+
+  auto work = [&](Totals& totals) {
+    std::unique_ptr<char[]> buffer(new char[READ_BUFFER_SIZE]);
+    for(size_t i = nextPath++; i < paths.size(); i = nextPath++) {
+      std::ifstream file;
+      file.rdbuf()->pubsetbuf(buffer.get(), READ_BUFFER_SIZE);
+      file.open(paths[i], std::ifstream::binary);
+      if(!file || !analyze(file, totals)) { totals.failures.push_back(paths[i]); }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for(unsigned int i = 1; i < threadCount; i++) { workers.emplace_back(work, std::ref(threadTotals[i])); }
+  work(threadTotals[0]);
+  for(auto& worker : workers) { worker.join(); }
+
+  for(unsigned int i = 1; i < threadCount; i++) { threadTotals[0].merge(threadTotals[i]); }
+  return std::move(threadTotals[0]);
+}
+
+void InputAnalyzer::replayFrame(Input& input, const InputFrame& previous, const InputFrame& frame, uint64_t timeNS, Totals& totals) const {
+  //only the buttons that changed are visited, so an idle keyboard costs a few XORs
+  RAWINPUT event = {};
+  event.header.dwType = RIM_TYPEKEYBOARD;
+  event.header.hDevice = KEYBOARD_HANDLE;
+  USHORT buttonFlags = 0;
+  std::array<uint64_t, 3> edges = {};
+  for(size_t word = 0; word < InputFrame::BUTTON_WORD_CT; word++) {
+    uint64_t changed = frame.buttons[word] ^ previous.buttons[word];
+    while(changed) {
+      size_t bit = word * 64 + Utility::lowestSetBit(changed);
+      changed &= changed - 1;
+
+      if(bit < InputFrame::KEYBOARD_BUTTON_OFFSET + InputFrame::KEYBOARD_BUTTON_CT) {
+        edges[static_cast<size_t>(Input::DeviceType::KEYBOARD)]++;
+        event.data.keyboard.VKey = static_cast<USHORT>(bit - InputFrame::KEYBOARD_BUTTON_OFFSET);
+        event.data.keyboard.Message = frame.held(bit) ? WM_KEYDOWN : WM_KEYUP;
+        input.injectEvent(event);
+      }
+      else if(bit >= InputFrame::MOUSE_BUTTON_OFFSET && bit < InputFrame::MOUSE_BUTTON_OFFSET + InputFrame::MOUSE_BUTTON_CT) {
+        //the mouse button flags are a down bit followed by an up bit for each button
+        edges[static_cast<size_t>(Input::DeviceType::MOUSE)]++;
+        size_t button = bit - InputFrame::MOUSE_BUTTON_OFFSET;
+        buttonFlags |= 1 << (button * 2 + (frame.held(bit) ? 0 : 1));
+      }
+      else if(bit >= InputFrame::GAMEPAD_BUTTON_OFFSET && bit < InputFrame::GAMEPAD_BUTTON_OFFSET + InputFrame::GAMEPAD_BUTTON_CT) {
+        //the pad's buttons are injected below with the rest of its state
+        edges[static_cast<size_t>(Input::DeviceType::GAMEPAD)]++;
+      }
+    }
+  }
+
+  //mouse axes are deltas, so any motion is a change, whereas the pad's only change when they differ
+  int16_t wheel = frame.axes[InputFrame::MOUSE_AXIS_OFFSET + Input::Mouse::DELTA_WHEEL];
+  bool mouseMoved = wheel || frame.axes[InputFrame::MOUSE_AXIS_OFFSET + Input::Mouse::DELTA_X] || frame.axes[InputFrame::MOUSE_AXIS_OFFSET + Input::Mouse::DELTA_Y];
+  bool padMoved = !std::equal(frame.axes.begin() + InputFrame::GAMEPAD_AXIS_OFFSET, frame.axes.begin() + InputFrame::GAMEPAD_AXIS_OFFSET + InputFrame::GAMEPAD_AXIS_CT,
+    previous.axes.begin() + InputFrame::GAMEPAD_AXIS_OFFSET);
+  for(size_t i = 0; i < edges.size(); i++) {
+    totals.edges[i] += edges[i];
+    bool moved = i == static_cast<size_t>(Input::DeviceType::MOUSE) ? mouseMoved : i == static_cast<size_t>(Input::DeviceType::GAMEPAD) && padMoved;
+    if(edges[i] || moved) { totals.activeFrames[i]++; }
+  }
+
+  if(buttonFlags || mouseMoved) {
+    event = {};
+    event.header.dwType = RIM_TYPEMOUSE;
+    event.header.hDevice = MOUSE_HANDLE;
+    event.data.mouse.lLastX = frame.axes[InputFrame::MOUSE_AXIS_OFFSET + Input::Mouse::DELTA_X];
+    event.data.mouse.lLastY = frame.axes[InputFrame::MOUSE_AXIS_OFFSET + Input::Mouse::DELTA_Y];
+    event.data.mouse.usButtonFlags = buttonFlags | (wheel ? RI_MOUSE_WHEEL : 0);
+    event.data.mouse.usButtonData = static_cast<USHORT>(wheel);
+    input.injectEvent(event);
+  }
+
+  //A headless Input has no pad to sample, so it reads as released unless a state is injected every frame.
+  XINPUT_GAMEPAD pad = {};
+  for(size_t i = 0; i < InputFrame::GAMEPAD_BUTTON_CT; i++) {
+    if(frame.held(InputFrame::GAMEPAD_BUTTON_OFFSET + i)) { pad.wButtons |= Input::Gamepad::xinputBit(i); }
+  }
+  auto axis = [&frame](size_t index) { return InputFrame::dequantizeUnit(frame.axes[InputFrame::GAMEPAD_AXIS_OFFSET + index]); };
+  pad.sThumbLX = static_cast<SHORT>(std::lround(axis(Input::Gamepad::LEFT_X)  * 32767));
+  pad.sThumbLY = static_cast<SHORT>(std::lround(axis(Input::Gamepad::LEFT_Y)  * 32767));
+  pad.sThumbRX = static_cast<SHORT>(std::lround(axis(Input::Gamepad::RIGHT_X) * 32767));
+  pad.sThumbRY = static_cast<SHORT>(std::lround(axis(Input::Gamepad::RIGHT_Y) * 32767));
+  pad.bLeftTrigger  = static_cast<BYTE>(std::lround(axis(Input::Gamepad::LTRIGGER) * 255));
+  pad.bRightTrigger = static_cast<BYTE>(std::lround(axis(Input::Gamepad::RTRIGGER) * 255));
+  input.injectGamepadState(pad, timeNS);
+
+  input.update(timeNS);
+
+  countRepeats(input.keyboard(), InputFrame::KEYBOARD_BUTTON_OFFSET, totals);
+  countRepeats(input.mouse(), InputFrame::MOUSE_BUTTON_OFFSET, totals);
+  countRepeats(input.gamepad(), InputFrame::GAMEPAD_BUTTON_OFFSET, totals);
+}
+
+void InputAnalyzer::countRepeats(const Input::DeviceState& state, size_t controlOffset, Totals& totals) {
+  for(size_t i : state.changedButtons) {
+    auto& btn = state.buttons[i];
+    if(btn.repeating && !btn.triggered) { totals.controls[controlOffset + i].repeats += btn.repeatCount; }
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <istream>
+#include <cstdint>
+#include "cl_Input.h"
+#include "cl_InputTelemetry.h"
+
+//Offline statistics over recorded input sessions: presses, hold durations, press intervals, repeats, and
+//how often each device changed. Recordings are in the stream format InputExporter writes (a uint16 length and an InputCodec
+//packet per frame, starting with a keyframe), so a session can be captured by saving the export pipe.
+//Each session is replayed frame by frame into a headless Input, so that the edges and repeats come from
+//the same device logic as in the game, with InputTelemetry doing the counting. Recordings are streamed a
+//packet at a time, so memory use doesn't depend on their size.
+//The stream has no timestamps, so frame times come from the frame numbers and a fixed frame period. It
+//has no raw input events either - only each frame's state - so device activity is measured in button
+//edges and in frames where the device changed, not in events.
+class InputAnalyzer {
+public:
+  typedef std::array<uint64_t, InputTelemetry::BUCKET_CT> Histogram;
+
+  struct ControlTotals {
+    uint64_t presses;
+    Histogram holdDurations;
+    Histogram pressIntervals;
+    //repeats that fired after the trigger frame (see Input::DeviceButton::repeatCount)
+    uint64_t repeats;
+  };
+
+  struct Totals {
+    uint64_t sessions = 0;
+    uint64_t frames = 0;
+    double seconds = 0;
+
+    //indexed by DeviceType - presses plus releases
+    std::array<uint64_t, 3> edges = {};
+    //indexed by DeviceType - frames in which a button changed or (mouse, gamepad) an axis moved
+    std::array<uint64_t, 3> activeFrames = {};
+
+    //indexed by InputFrame button bit
+    std::array<ControlTotals, InputFrame::BUTTON_BIT_CT> controls;
+
+    //recordings that couldn't be opened or were malformed (what was read before the error still counts)
+    std::vector<std::string> failures;
+
+    Totals();
+    void merge(const Totals& other);
+  };
+
+  //'framePeriodMS' is the frame period the recordings were made at
+  explicit InputAnalyzer(double framePeriodMS);
+
+  //replays one recording into 'totals' - returns false if it is malformed
+  bool analyze(std::istream& recording, Totals& totals) const;
+
+  //Analyzes every file on 'threadCount' threads, each taking the next file as it finishes the last. Every
+  //thread keeps its own totals, which are merged at the end.
+  Totals analyzeFiles(const std::vector<std::string>& paths, unsigned int threadCount) const;
+
+private:
+  //fake raw input handles for the replayed keyboard and mouse
+  static const HANDLE KEYBOARD_HANDLE;
+  static const HANDLE MOUSE_HANDLE;
+
+  const uint64_t framePeriodNS;
+
+  //feeds the difference between two frames to 'input', updates it and counts device activity
+  void replayFrame(Input& input, const InputFrame& previous, const InputFrame& frame, uint64_t timeNS, Totals& totals) const;
+  static void countRepeats(const Input::DeviceState& state, size_t controlOffset, Totals& totals);
+
+};
@@ -0,0 +1,112 @@
+#include "cl_InputBroadcast.h"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+InputBroadcast::InputBroadcast(Input& input, const std::wstring& name) : input(input) {
+  mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(MAPPING_SIZE), name.c_str());
+  if(!mapping) { throw std::runtime_error("Failed to create input broadcast mapping."); }
+  if(GetLastError() == ERROR_ALREADY_EXISTS) {
+    CloseHandle(mapping);
+    throw std::runtime_error("Input broadcast name is already in use.");
+  }
+
+  view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, MAPPING_SIZE);
+  if(!view) {
+    CloseHandle(mapping);
+    throw std::runtime_error("Failed to map input broadcast.");
+  }
+
+  //new mappings are zeroed, so every slot starts out holding no frame
+  Header& head = header(view);
+  head.magic = MAGIC;
+  head.version = VERSION;
+  head.slotCount = SLOT_CT;
+  head.slotSize = sizeof(Slot);
+  head.published.store(0, std::memory_order_release);
+
+  frameSubscription = input.subscribeFrame([this]() { publish(); });
+}
+
+InputBroadcast::~InputBroadcast() {
+  input.unsubscribe(frameSubscription);
+  UnmapViewOfFile(view);
+  CloseHandle(mapping);
+}
+
+void InputBroadcast::publish() {
+  Header& head = header(view);
+  uint64_t index = head.published.load(std::memory_order_relaxed);
+  Slot& target = slot(view, index);
+
+  //readers that see the odd sequence, or see it change while they copy, discard what they read
+  target.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  Frame& frame = target.frame;
+  frame.timeNS = input.frameTimeNS();
+  input.captureFrame(frame.state);
+  frame.triggered = input.triggeredWords();
+  frame.released = input.releasedWords();
+
+  target.sequence.store(2 * index + 2, std::memory_order_release);
+  head.published.store(index + 1, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////
+
+InputBroadcast::Reader::Reader(const std::wstring& name) {
+  //The reader never stores anything, but it still needs write access: on 32-bit x86 a 64-bit atomic load is
+  //a lock cmpxchg8b, which faults on a read-only page.
+  mapping = OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name.c_str());
+  if(!mapping) { throw std::runtime_error("No input broadcast is running."); }
+
+  view = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, MAPPING_SIZE);
+  if(!view) {
+    CloseHandle(mapping);
+    throw std::runtime_error("Failed to map input broadcast.");
+  }
+
+  const Header& head = header(view);
+  if(head.magic != MAGIC || head.version != VERSION || head.slotCount != SLOT_CT || head.slotSize != sizeof(Slot)) {
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    throw std::runtime_error("Input broadcast version mismatch.");
+  }
+
+  next = head.published.load(std::memory_order_acquire);
+}
+
+InputBroadcast::Reader::~Reader() {
+  UnmapViewOfFile(view);
+  CloseHandle(mapping);
+}
+
+InputBroadcast::Reader::Result InputBroadcast::Reader::read(Frame& frame) {
+  uint64_t published = header(view).published.load(std::memory_order_acquire);
+  if(next >= published) { return Result::NO_FRAME; }
+
+  if(published - next >= SLOT_CT) { return overrun(published); }
+
+  Slot& source = slot(view, next);
+  uint64_t expected = 2 * next + 2;
+  if(source.sequence.load(std::memory_order_acquire) != expected) { return overrun(header(view).published.load(std::memory_order_acquire)); }
+
+  std::memcpy(&frame, &source.frame, sizeof(frame));
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if(source.sequence.load(std::memory_order_relaxed) != expected) { return overrun(header(view).published.load(std::memory_order_acquire)); }
+
+  next++;
+  return Result::FRAME;
+}
+
+InputBroadcast::Reader::Result InputBroadcast::Reader::overrun(uint64_t published) {
+  //The oldest slot is the next one the writer will overwrite, so it's skipped as well
+  //to give the reader a frame's worth of headroom.
+  uint64_t oldest = published >= SLOT_CT ? published - SLOT_CT + 1 : 0;
+  uint64_t resume = (std::max)(oldest, next + 1);
+  lost += resume - next;
+  next = resume;
+  return Result::OVERRUN;
+}
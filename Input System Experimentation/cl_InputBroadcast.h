@@ -0,0 +1,102 @@
+#pragma once
+#include <Windows.h>
+#include <array>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Publishes the merged input state into shared memory every frame, so that companion processes (overlays,
+//recorders, accessibility tools) can follow the input without registering for raw input themselves.
+//The mapping holds a versioned header and a ring of frames. Each slot carries its own sequence number,
+//which makes it a seqlock: readers never block the writer, and a reader that falls more than a ring's
+//worth behind notices that its slot was overwritten instead of reading a torn frame.
+class InputBroadcast {
+public:
+  static constexpr const wchar_t* DEFAULT_NAME = L"Local\\InputSystemBroadcast";
+
+  //bumped whenever the layout of the mapping changes
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t MAGIC = 0x42504E49; //"INPB"
+
+  //about four seconds of frames at 60Hz
+  static constexpr uint32_t SLOT_CT = 256;
+
+  struct Frame {
+    uint64_t timeNS;
+
+    //held buttons, axes and frame number of the merged keyboard, mouse and gamepad
+    InputFrame state;
+
+    //The frame's button edges, in the same bit layout as InputFrame's held buttons. A button tapped
+    //within the frame is in both.
+    std::array<uint64_t, InputFrame::BUTTON_WORD_CT> triggered;
+    std::array<uint64_t, InputFrame::BUTTON_WORD_CT> released;
+  };
+
+  //throws if the mapping can't be created or another broadcaster already owns the name
+  InputBroadcast(Input& input, const std::wstring& name = DEFAULT_NAME);
+  ~InputBroadcast();
+
+  InputBroadcast(const InputBroadcast&) = delete;
+  void operator=(const InputBroadcast&) = delete;
+
+  //Follows a broadcast from another process. Reading is wait-free - a read copies one slot and checks
+  //that the slot wasn't rewritten in the meantime.
+  class Reader {
+  public:
+    enum class Result { FRAME, NO_FRAME, OVERRUN };
+
+    //starts at the next frame to be published - throws if there is no broadcast or its version differs
+    Reader(const std::wstring& name = DEFAULT_NAME);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    void operator=(const Reader&) = delete;
+
+    //OVERRUN means frames were lost because the reader fell behind - reading continues from the oldest
+    //frame that is still available
+    Result read(Frame& frame);
+
+    //total frames lost to overruns
+    uint64_t lostFrames() const { return lost; }
+
+  private:
+    HANDLE mapping;
+    void* view;
+    uint64_t next;
+    uint64_t lost = 0;
+
+    Result overrun(uint64_t published);
+
+  };
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    //number of frames published so far - frame n lives in slot n % slotCount
+    std::atomic<uint64_t> published;
+  };
+
+  struct Slot {
+    //2n + 1 while frame n is being written, 2n + 2 once it is complete
+    std::atomic<uint64_t> sequence;
+    Frame frame;
+  };
+
+  static constexpr size_t MAPPING_SIZE = sizeof(Header) + SLOT_CT * sizeof(Slot);
+
+  static Header& header(void* view) { return *static_cast<Header*>(view); }
+  static Slot& slot(void* view, uint64_t index) { return static_cast<Slot*>(static_cast<void*>(static_cast<Header*>(view) + 1))[index % SLOT_CT]; }
+
+  Input& input;
+  Input::SubscriptionID frameSubscription;
+  HANDLE mapping;
+  void* view;
+
+  void publish();
+
+};
@@ -0,0 +1,54 @@
+#include "cl_InputBuffer.h"
+
+InputBuffer::InputBuffer() {
+  reset();
+}
+
+void InputBuffer::reset() {
+  controls.fill(ControlRing{ {}, {}, 0, 0, 0, 0, false });
+}
+
+bool InputBuffer::pressedWithin(size_t control, uint64_t windowNS) const {
+  auto& ring = controls[control];
+  if(ring.pressCount == ring.consumed) { return false; }
+  return age(ring.presses[(ring.pressCount - 1) % DEPTH]) <= windowNS;
+}
+
+bool InputBuffer::releasedWithin(size_t control, uint64_t windowNS) const {
+  auto& ring = controls[control];
+  if(!ring.hasReleased) { return false; }
+  return age(ring.releases[(ring.releaseCount - 1) % DEPTH]) <= windowNS;
+}
+
+unsigned int InputBuffer::pressesWithin(size_t control, uint64_t windowNS) const {
+  auto& ring = controls[control];
+  unsigned int count = 0;
+
+  //newest first, stopping at the first press outside the window
+  while(count < ring.storedPresses) {
+    if(age(ring.presses[(ring.pressCount - 1 - count) % DEPTH]) > windowNS) { break; }
+    count++;
+  }
+  return count;
+}
+
+bool InputBuffer::consumePress(size_t control) {
+  auto& ring = controls[control];
+  if(ring.pressCount == ring.consumed) { return false; }
+  ring.consumed = ring.pressCount;
+  return true;
+}
+
+void InputBuffer::press(size_t control, uint64_t timeNS) {
+  auto& ring = controls[control];
+  ring.presses[ring.pressCount % DEPTH] = timeNS;
+  ring.pressCount++;
+  if(ring.storedPresses < DEPTH) { ring.storedPresses++; }
+}
+
+void InputBuffer::release(size_t control) {
+  auto& ring = controls[control];
+  ring.releases[ring.releaseCount % DEPTH] = frameTime;
+  ring.releaseCount++;
+  ring.hasReleased = true;
+}
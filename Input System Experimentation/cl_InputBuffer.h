@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "st_InputFrame.h"
+
+//Recent press and release times of every button, for jump buffering, coyote time, parry windows and the like.
+//Each control keeps a small ring of its latest presses and releases along with a consumed marker, so a
+//gameplay system can ask "was this pressed in the last N ms and has nobody acted on it yet?" in O(1)
+//without keeping its own history. Controls are indexed by InputFrame button bit.
+//Times are steady_clock nanoseconds and windows are measured back from the current frame's time, so a
+//press shows up as within any window on the frame it happens.
+class InputBuffer {
+public:
+  //presses and releases remembered per control - older ones are overwritten
+  static constexpr size_t DEPTH = 4;
+
+  InputBuffer();
+
+  //forgets every press and release
+  void reset();
+
+  //true if the newest press is unconsumed and happened no more than 'windowNS' before the current frame
+  bool pressedWithin(size_t control, uint64_t windowNS) const;
+  bool releasedWithin(size_t control, uint64_t windowNS) const;
+
+  //presses in the window, consumed or not, counting at most DEPTH (e.g. 2 for a double tap)
+  unsigned int pressesWithin(size_t control, uint64_t windowNS) const;
+
+  //Marks every press so far as consumed, so pressedWithin() is false until the control is pressed again.
+  //Returns false if there was nothing to consume.
+  bool consumePress(size_t control);
+
+  //Input records every edge here as its device produces it. Presses keep their own time, since a polled
+  //gamepad stamps them with their sample time, while a release goes in at the time of the frame it ends in.
+  void beginFrame(uint64_t frameTimeNS) { frameTime = frameTimeNS; }
+  void press(size_t control, uint64_t timeNS);
+  void release(size_t control);
+
+private:
+  struct ControlRing {
+    std::array<uint64_t, DEPTH> presses;
+    std::array<uint64_t, DEPTH> releases;
+
+    //Totals so far - press n is in presses[n % DEPTH]. Presses below 'consumed' have been consumed.
+    //These may wrap, so they are only ever compared for equality or used as ring indices.
+    uint32_t pressCount;
+    uint32_t releaseCount;
+    uint32_t consumed;
+
+    //how many entries of 'presses' hold a press (at most DEPTH), and whether 'releases' holds any
+    uint8_t storedPresses;
+    bool hasReleased;
+  };
+  //ring indices stay in order when the counts wrap
+  static_assert((DEPTH & (DEPTH - 1)) == 0, "DEPTH must be a power of two");
+
+  std::array<ControlRing, InputFrame::BUTTON_BIT_CT> controls;
+  uint64_t frameTime = 0;
+
+  //how long before the current frame 'timeNS' was
+  uint64_t age(uint64_t timeNS) const { return frameTime > timeNS ? frameTime - timeNS : 0; }
+
+};
@@ -0,0 +1,200 @@
+#include "cl_InputCodec.h"
+#include "ns_Utility.h"
+
+namespace {
+  //Bits are packed LSB first. The writer never touches memory past 'capacity'; it flags the overflow instead.
+  class BitWriter {
+  public:
+    BitWriter(uint8_t* out, size_t capacity) : out(out), capacity(capacity) {}
+
+    void write(uint32_t value, unsigned int bitCt) {
+      acc |= static_cast<uint64_t>(value) << accBits;
+      accBits += bitCt;
+      while(accBits >= 8) { emit(); }
+    }
+
+    //'groupBits' data bits per group, each group followed by a continuation bit
+    void writeVarint(uint32_t value, unsigned int groupBits) {
+      uint32_t groupMask = (1u << groupBits) - 1;
+      while(value > groupMask) {
+        write((value & groupMask) | (1u << groupBits), groupBits + 1);
+        value >>= groupBits;
+      }
+      write(value, groupBits + 1);
+    }
+
+    //returns the byte count, or 0 on overflow
+    size_t finish() {
+      if(accBits > 0) { emit(); }
+      return overflowed ? 0 : size;
+    }
+
+  private:
+    uint8_t* out;
+    size_t capacity;
+    size_t size = 0;
+    uint64_t acc = 0;
+    unsigned int accBits = 0;
+    bool overflowed = false;
+
+    void emit() {
+      if(size < capacity) { out[size++] = static_cast<uint8_t>(acc); }
+      else { overflowed = true; }
+      acc >>= 8;
+      accBits = accBits >= 8 ? accBits - 8 : 0;
+    }
+
+  };
+
+  class BitReader {
+  public:
+    BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint32_t read(unsigned int bitCt) {
+      while(accBits < bitCt) {
+        if(pos < size) { acc |= static_cast<uint64_t>(data[pos++]) << accBits; }
+        else { overrun = true; }
+        accBits += 8;
+      }
+      uint32_t value = static_cast<uint32_t>(acc & ((uint64_t(1) << bitCt) - 1));
+      acc >>= bitCt;
+      accBits -= bitCt;
+      return value;
+    }
+
+    uint32_t readVarint(unsigned int groupBits) {
+      uint32_t value = 0;
+      for(unsigned int shift = 0; shift < 32; shift += groupBits) {
+        uint32_t group = read(groupBits + 1);
+        value |= (group & ((1u << groupBits) - 1)) << shift;
+        if(!(group >> groupBits)) { return value; }
+      }
+      overrun = true;
+      return value;
+    }
+
+    bool failed() const { return overrun; }
+
+  private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    uint64_t acc = 0;
+    unsigned int accBits = 0;
+    bool overrun = false;
+
+  };
+
+  //group sizes are picked for the typical magnitudes of each field
+  constexpr unsigned int FRAME_GROUP_BITS = 7;
+  constexpr unsigned int DELTA_GROUP_BITS = 3;
+  constexpr unsigned int CHECK_BITS       = 8;
+  constexpr unsigned int GAP_GROUP_BITS   = 3;
+  constexpr unsigned int AXIS_GROUP_BITS  = 5;
+
+  uint32_t zigzag(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+  int32_t unzigzag(uint32_t value) { return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1); }
+
+  const InputFrame EMPTY_FRAME;
+
+  //A byte folded from the whole baseline. Delta frames only carry their distance from the baseline, so
+  //this is what catches a frame being decoded against a different baseline than it was encoded against.
+  uint32_t baselineCheck(const InputFrame& baseline) {
+    uint32_t hash = 2166136261u;
+    auto add = [&hash](uint32_t value) { hash = (hash ^ value) * 16777619u; };
+    add(baseline.frameNumber);
+    for(uint64_t word : baseline.buttons) {
+      add(static_cast<uint32_t>(word));
+      add(static_cast<uint32_t>(word >> 32));
+    }
+    for(int16_t axis : baseline.axes) { add(static_cast<uint16_t>(axis)); }
+    return (hash ^ (hash >> 8) ^ (hash >> 16) ^ (hash >> 24)) & ((1u << CHECK_BITS) - 1);
+  }
+}
+
+size_t InputCodec::encode(const InputFrame& frame, const InputFrame* baseline, uint8_t* out, size_t capacity) {
+  const InputFrame& base = baseline ? *baseline : EMPTY_FRAME;
+  BitWriter writer(out, capacity);
+
+  writer.write(baseline ? 1 : 0, 1);
+  if(baseline) {
+    writer.writeVarint(frame.frameNumber - baseline->frameNumber, DELTA_GROUP_BITS);
+    writer.write(baselineCheck(*baseline), CHECK_BITS);
+  }
+  else {
+    writer.writeVarint(frame.frameNumber, FRAME_GROUP_BITS);
+  }
+
+  //gather the changed button bits first since the count is sent ahead of them
+  uint16_t changed[InputFrame::BUTTON_BIT_CT];
+  size_t changedCt = 0;
+  for(size_t word = 0; word < InputFrame::BUTTON_WORD_CT; word++) {
+    uint64_t diff = frame.buttons[word] ^ base.buttons[word];
+    while(diff) {
+      changed[changedCt++] = static_cast<uint16_t>(word * 64 + Utility::lowestSetBit(diff));
+      diff &= diff - 1;
+    }
+  }
+
+  uint32_t axisMask = 0;
+  for(size_t i = 0; i < InputFrame::AXIS_CT; i++) {
+    if(frame.axes[i] != base.axes[i]) { axisMask |= 1u << i; }
+  }
+
+  //an unchanged frame ends after a single bit
+  bool anyChanged = changedCt > 0 || axisMask != 0;
+  writer.write(anyChanged ? 1 : 0, 1);
+  if(!anyChanged) { return writer.finish(); }
+
+  writer.writeVarint(static_cast<uint32_t>(changedCt), GAP_GROUP_BITS);
+  size_t next = 0;
+  for(size_t i = 0; i < changedCt; i++) {
+    writer.writeVarint(static_cast<uint32_t>(changed[i] - next), GAP_GROUP_BITS);
+    next = changed[i] + 1;
+  }
+
+  writer.write(axisMask, InputFrame::AXIS_CT);
+  for(size_t i = 0; i < InputFrame::AXIS_CT; i++) {
+    if(axisMask & (1u << i)) { writer.writeVarint(zigzag(frame.axes[i] - base.axes[i]), AXIS_GROUP_BITS); }
+  }
+
+  return writer.finish();
+}
+
+bool InputCodec::decode(const uint8_t* data, size_t size, const InputFrame* baseline, InputFrame& frame) {
+  BitReader reader(data, size);
+
+  bool hasBaseline = reader.read(1) != 0;
+  if(hasBaseline != (baseline != nullptr)) { return false; }
+  const InputFrame& base = baseline ? *baseline : EMPTY_FRAME;
+
+  if(baseline) {
+    frame.frameNumber = baseline->frameNumber + reader.readVarint(DELTA_GROUP_BITS);
+    if(reader.read(CHECK_BITS) != baselineCheck(*baseline)) { return false; }
+  }
+  else {
+    frame.frameNumber = reader.readVarint(FRAME_GROUP_BITS);
+  }
+
+  frame.buttons = base.buttons;
+  frame.axes = base.axes;
+  if(!reader.read(1)) { return !reader.failed(); }
+
+  uint32_t changedCt = reader.readVarint(GAP_GROUP_BITS);
+  if(changedCt > InputFrame::BUTTON_BIT_CT) { return false; }
+
+  size_t next = 0;
+  for(uint32_t i = 0; i < changedCt; i++) {
+    size_t bit = next + reader.readVarint(GAP_GROUP_BITS);
+    if(bit >= InputFrame::BUTTON_BIT_CT) { return false; }
+    frame.buttons[bit / 64] ^= uint64_t(1) << (bit % 64);
+    next = bit + 1;
+  }
+
+  uint32_t axisMask = reader.read(InputFrame::AXIS_CT);
+  for(size_t i = 0; i < InputFrame::AXIS_CT; i++) {
+    if(axisMask & (1u << i)) { frame.axes[i] = static_cast<int16_t>(base.axes[i] + unzigzag(reader.readVarint(AXIS_GROUP_BITS))); }
+  }
+
+  return !reader.failed();
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "st_InputFrame.h"
+
+//Bit-packed, delta-encoded wire format for InputFrame.
+//A frame is encoded against a baseline the receiver is known to have (normally the last acknowledged
+//frame), so only the buttons that changed since then are sent - as varint run lengths between changed
+//bits - along with the axes whose quantized values differ. Encoding without a baseline produces a
+//keyframe that is a delta against the all-released frame.
+//Delta frames don't carry their frame number, only its distance from the baseline's and a check byte of
+//the baseline, so a frame with nothing changed a few frames after its baseline takes 2 bytes.
+//Neither encode() nor decode() allocates.
+class InputCodec {
+public:
+  //Worst case is ~200 bytes (every button and axis changed and a 32 bit frame number gap), but a
+  //frame with a couple of changes usually fits in 3 to 5 bytes.
+  static constexpr size_t MAX_ENCODED_SIZE = 256;
+
+  //returns the number of bytes written, or 0 if 'capacity' was too small
+  static size_t encode(const InputFrame& frame, const InputFrame* baseline, uint8_t* out, size_t capacity);
+
+  //Returns false if the data is malformed or was encoded against a baseline other than the one provided
+  //('baseline' must be null for keyframes). 'frame' is unspecified when this fails.
+  static bool decode(const uint8_t* data, size_t size, const InputFrame* baseline, InputFrame& frame);
+
+};
@@ -0,0 +1,224 @@
+#include "cl_InputConfig.h"
+#include "cl_Input.h"
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+  //profile IDs are a uint8_t
+  constexpr size_t MAX_PROFILES = 256;
+
+  struct Name {
+    const char* name;
+    unsigned int value;
+  };
+
+  const Name AXIS_NAMES[] = {
+    { "LEFT_X",   Input::Gamepad::LEFT_X },   { "LEFT_Y",   Input::Gamepad::LEFT_Y },
+    { "RIGHT_X",  Input::Gamepad::RIGHT_X },  { "RIGHT_Y",  Input::Gamepad::RIGHT_Y },
+    { "LTRIGGER", Input::Gamepad::LTRIGGER }, { "RTRIGGER", Input::Gamepad::RTRIGGER }
+  };
+
+  const Name MOUSE_NAMES[] = {
+    { "L_BUTTON", Input::Mouse::L_BUTTON }, { "R_BUTTON", Input::Mouse::R_BUTTON }, { "WHEEL_BUTTON", Input::Mouse::WHEEL_BUTTON },
+    { "BACK", Input::Mouse::BACK }, { "FORWARD", Input::Mouse::FORWARD }
+  };
+
+  const Name PAD_NAMES[] = {
+    { "DPAD_UP", Input::Gamepad::DPAD_UP }, { "DPAD_DOWN", Input::Gamepad::DPAD_DOWN },
+    { "DPAD_LEFT", Input::Gamepad::DPAD_LEFT }, { "DPAD_RIGHT", Input::Gamepad::DPAD_RIGHT },
+    { "START", Input::Gamepad::START }, { "BACK", Input::Gamepad::BACK },
+    { "LTHUMB", Input::Gamepad::LTHUMB }, { "RTHUMB", Input::Gamepad::RTHUMB },
+    { "LSHOULDER", Input::Gamepad::LSHOULDER }, { "RSHOULDER", Input::Gamepad::RSHOULDER },
+    { "A", Input::Gamepad::A }, { "B", Input::Gamepad::B }, { "X", Input::Gamepad::X }, { "Y", Input::Gamepad::Y }
+  };
+
+  //letters, digits and F1-F24 are handled separately
+  const Name KEY_NAMES[] = {
+    { "BACKSPACE", VK_BACK }, { "TAB", VK_TAB }, { "ENTER", VK_RETURN }, { "ESCAPE", VK_ESCAPE }, { "SPACE", VK_SPACE },
+    { "SHIFT", VK_SHIFT }, { "CONTROL", VK_CONTROL }, { "ALT", VK_MENU },
+    { "LSHIFT", VK_LSHIFT }, { "RSHIFT", VK_RSHIFT }, { "LCONTROL", VK_LCONTROL }, { "RCONTROL", VK_RCONTROL },
+    { "LEFT", VK_LEFT }, { "UP", VK_UP }, { "RIGHT", VK_RIGHT }, { "DOWN", VK_DOWN },
+    { "INSERT", VK_INSERT }, { "DELETE", VK_DELETE }, { "HOME", VK_HOME }, { "END", VK_END },
+    { "PAGEUP", VK_PRIOR }, { "PAGEDOWN", VK_NEXT }
+  };
+
+  template<size_t N>
+  bool lookup(const Name (&names)[N], const std::string& name, unsigned int& value) {
+    for(auto& entry : names) {
+      if(name == entry.name) {
+        value = entry.value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool parseUInt(const std::string& token, unsigned int& value) {
+    if(token.empty() || token[0] == '-' || token[0] == '+') { return false; }
+    char* end;
+    unsigned long parsed = std::strtoul(token.c_str(), &end, 0);
+    if(*end || parsed > 0xFFFFFFFFul) { return false; }
+    value = static_cast<unsigned int>(parsed);
+    return true;
+  }
+
+  bool parseKey(const std::string& name, unsigned int& vk) {
+    if(name.size() == 1 && ((name[0] >= 'A' && name[0] <= 'Z') || (name[0] >= '0' && name[0] <= '9'))) {
+      //VK codes for letters and digits are their ASCII codes
+      vk = static_cast<unsigned char>(name[0]);
+      return true;
+    }
+
+    unsigned int function;
+    if(name.size() > 1 && name[0] == 'F' && parseUInt(name.substr(1), function) && function >= 1 && function <= 24) {
+      vk = VK_F1 + function - 1;
+      return true;
+    }
+
+    if(lookup(KEY_NAMES, name, vk)) { return true; }
+    return name.compare(0, 2, "0x") == 0 && parseUInt(name, vk) && vk > 0 && vk < InputFrame::KEYBOARD_BUTTON_CT;
+  }
+
+  //returns the InputFrame button bit of a device:button control
+  bool parseControl(const std::string& token, uint16_t& control) {
+    size_t colon = token.find(':');
+    if(colon == std::string::npos) { return false; }
+    std::string device = token.substr(0, colon);
+    std::string name = token.substr(colon + 1);
+
+    unsigned int button;
+    if(device == "key" && parseKey(name, button)) {
+      control = static_cast<uint16_t>(InputFrame::KEYBOARD_BUTTON_OFFSET + button);
+      return true;
+    }
+    if(device == "mouse" && lookup(MOUSE_NAMES, name, button)) {
+      control = static_cast<uint16_t>(InputFrame::MOUSE_BUTTON_OFFSET + button);
+      return true;
+    }
+    if(device == "pad" && lookup(PAD_NAMES, name, button)) {
+      control = static_cast<uint16_t>(InputFrame::GAMEPAD_BUTTON_OFFSET + button);
+      return true;
+    }
+    return false;
+  }
+}
+
+InputConfig::InputConfig() {
+  //the same defaults as a new Input
+  axisDeadZones.fill(Input::DEFAULT_DEAD_ZONE);
+  profiles.push_back(RepeatProfile{ 0, 0 });
+  profiles.push_back(RepeatProfile{ Input::DEFAULT_REPEAT_DELAY_MS, Input::DEFAULT_REPEAT_PERIOD_MS });
+  controlProfiles.fill(Input::DEFAULT_REPEAT);
+}
+
+std::unique_ptr<InputConfig> InputConfig::parse(std::istream& text, std::string& error) {
+  std::unique_ptr<InputConfig> config(new InputConfig());
+  std::map<std::string, uint8_t> profileIDs = { { "never", Input::NEVER_REPEAT }, { "default", Input::DEFAULT_REPEAT } };
+  //ordered by name, so the same file always builds the same table
+  std::map<std::string, std::vector<uint16_t>> actionControls;
+
+  std::string line;
+  for(size_t lineNumber = 1; std::getline(text, line); lineNumber++) {
+    auto fail = [&error, lineNumber](const std::string& message) {
+      error = "line " + std::to_string(lineNumber) + ": " + message;
+      return nullptr;
+    };
+
+    size_t comment = line.find('#');
+    if(comment != std::string::npos) { line.erase(comment); }
+
+    std::istringstream tokens(line);
+    std::vector<std::string> args;
+    for(std::string token; tokens >> token;) { args.push_back(token); }
+    if(args.empty()) { continue; }
+    const std::string& directive = args[0];
+
+    if(directive == "deadzone") {
+      unsigned int axis;
+      if(args.size() != 3) { return fail("expected 'deadzone <axis> <radius>'"); }
+      if(!lookup(AXIS_NAMES, args[1], axis)) { return fail("unknown axis '" + args[1] + "'"); }
+      char* end;
+      float radius = std::strtof(args[2].c_str(), &end);
+      if(*end || !(radius >= 0 && radius < 1)) { return fail("dead zone radius must be at least 0 and less than 1"); }
+      config->axisDeadZones[axis] = radius;
+    }
+    else if(directive == "repeat" || directive == "profile") {
+      //'repeat' is the same as a profile declaration for 'default'
+      size_t nameCt = directive == "profile" ? 1 : 0;
+      RepeatProfile profile;
+      if(args.size() != 3 + nameCt) { return fail(nameCt ? "expected 'profile <name> <delayMS> <periodMS>'" : "expected 'repeat <delayMS> <periodMS>'"); }
+      if(!parseUInt(args[1 + nameCt], profile.delayMS) || !parseUInt(args[2 + nameCt], profile.periodMS)) { return fail("invalid repeat time"); }
+      if(profile.periodMS == 0) { return fail("repeat period must be nonzero"); }
+
+      if(!nameCt) {
+        config->profiles[Input::DEFAULT_REPEAT] = profile;
+        continue;
+      }
+      if(profileIDs.count(args[1])) { return fail("profile '" + args[1] + "' is already declared"); }
+      if(config->profiles.size() == MAX_PROFILES) { return fail("too many profiles"); }
+      profileIDs[args[1]] = static_cast<uint8_t>(config->profiles.size());
+      config->profiles.push_back(profile);
+    }
+    else if(directive == "repeatwith" || directive == "bind") {
+      if(args.size() < 3) { return fail("expected '" + directive + " <" + (directive == "bind" ? "action" : "profile") + "> <control>...'"); }
+
+      uint8_t profile = 0;
+      if(directive == "repeatwith") {
+        auto iter = profileIDs.find(args[1]);
+        if(iter == profileIDs.end()) { return fail("unknown profile '" + args[1] + "' (profiles must be declared before use)"); }
+        profile = iter->second;
+      }
+
+      for(size_t i = 2; i < args.size(); i++) {
+        uint16_t control;
+        if(!parseControl(args[i], control)) { return fail("unknown control '" + args[i] + "'"); }
+        if(directive == "repeatwith") {
+          config->controlProfiles[control] = profile;
+          continue;
+        }
+        auto& controls = actionControls[args[1]];
+        if(std::find(controls.begin(), controls.end(), control) == controls.end()) { controls.push_back(control); }
+      }
+    }
+    else {
+      return fail("unknown directive '" + directive + "'");
+    }
+  }
+
+  if(text.bad()) {
+    error = "read failed";
+    return nullptr;
+  }
+
+  for(auto& action : actionControls) {
+    config->actions.push_back(Action{ actionID(action.first.c_str()), static_cast<uint32_t>(config->boundControls.size()), static_cast<uint32_t>(action.second.size()) });
+    config->boundControls.insert(config->boundControls.end(), action.second.begin(), action.second.end());
+  }
+  std::sort(config->actions.begin(), config->actions.end(), [](const Action& a, const Action& b) { return a.id < b.id; });
+
+  //two names hashing alike would silently share bindings, so it is reported instead
+  for(size_t i = 1; i < config->actions.size(); i++) {
+    if(config->actions[i].id != config->actions[i - 1].id) { continue; }
+    std::string names;
+    for(auto& action : actionControls) {
+      if(actionID(action.first.c_str()) == config->actions[i].id) { names += " '" + action.first + "'"; }
+    }
+    error = "actions" + names + " have the same ID - rename one of them";
+    return nullptr;
+  }
+
+  return config;
+}
+
+const uint16_t* InputConfig::bindings(ActionID action, size_t& count) const {
+  auto iter = std::lower_bound(actions.begin(), actions.end(), action, [](const Action& a, ActionID id) { return a.id < id; });
+  if(iter == actions.end() || iter->id != action) {
+    count = 0;
+    return nullptr;
+  }
+  count = iter->count;
+  return boundControls.data() + iter->first;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <istream>
+#include <memory>
+#include <cstdint>
+#include "st_InputFrame.h"
+
+//A parsed and validated input configuration - gamepad dead zones, repeat profiles and which buttons use
+//them, and action bindings. A configuration never changes once it is built, so a whole one can be handed
+//to the game thread and read there without locking (see InputConfigWatcher and Input::watchConfig()).
+//
+//The text format is one directive per line, and '#' starts a comment:
+//  deadzone <axis> <radius>              axis is a Gamepad::Axes name (LEFT_X), radius is in [0, 1)
+//  repeat <delayMS> <periodMS>           the DEFAULT_REPEAT profile
+//  profile <name> <delayMS> <periodMS>   declares another repeat profile
+//  repeatwith <profile> <control>...     assigns a profile - 'never' and 'default' are built in
+//  bind <action> <control>...            adds controls to an action
+//Controls are written as device:button -
+//  key:0x41 (a VK code), key:A (a letter or digit), or a key name such as key:SPACE or key:F1
+//  mouse:L_BUTTON (an Input::Mouse::Buttons name)
+//  pad:A (an Input::Gamepad::Buttons name)
+//Whatever the text doesn't mention has the same defaults as a new Input, so a file describes the whole
+//configuration and removing a line undoes it.
+class InputConfig {
+public:
+  //Actions are identified by a hash of their name, so an ID can be worked out once (even at compile time)
+  //and stays valid across reloads no matter how the file orders the actions.
+  typedef uint32_t ActionID;
+  static constexpr ActionID actionID(const char* name, ActionID hash = 2166136261u) {
+    //FNV-1a
+    return *name ? actionID(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+  }
+
+  struct RepeatProfile {
+    unsigned int delayMS;
+    unsigned int periodMS;
+  };
+
+  //the defaults
+  InputConfig();
+
+  //returns null and describes the first problem in 'error' if the text is invalid
+  static std::unique_ptr<InputConfig> parse(std::istream& text, std::string& error);
+
+  //indexed by Input::Gamepad::Axes
+  const std::array<float, InputFrame::GAMEPAD_AXIS_CT>& deadZones() const { return axisDeadZones; }
+
+  //indexed by Input::RepeatProfileID - entry 0 is NEVER_REPEAT and entry 1 is DEFAULT_REPEAT
+  const std::vector<RepeatProfile>& repeatProfiles() const { return profiles; }
+
+  //the Input::RepeatProfileID of every button, indexed by InputFrame button bit
+  const std::array<uint8_t, InputFrame::BUTTON_BIT_CT>& buttonProfiles() const { return controlProfiles; }
+
+  //The InputFrame button bits bound to 'action' - 'count' is 0 if the action isn't bound.
+  //A binary search over the actions, so it doesn't depend on how many controls are bound.
+  const uint16_t* bindings(ActionID action, size_t& count) const;
+
+private:
+  std::array<float, InputFrame::GAMEPAD_AXIS_CT> axisDeadZones;
+  std::vector<RepeatProfile> profiles;
+  std::array<uint8_t, InputFrame::BUTTON_BIT_CT> controlProfiles;
+
+  //sorted by ID, each owning 'count' entries of 'boundControls' from 'first'
+  struct Action {
+    ActionID id;
+    uint32_t first;
+    uint32_t count;
+  };
+  std::vector<Action> actions;
+  std::vector<uint16_t> boundControls;
+
+};
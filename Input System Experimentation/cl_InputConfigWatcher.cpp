@@ -0,0 +1,79 @@
+#include "cl_InputConfigWatcher.h"
+#include <fstream>
+
+InputConfigWatcher::InputConfigWatcher(const std::string& path, unsigned int pollMS) :
+  path(path),
+  pollInterval(pollMS)
+{
+  worker = std::thread([this]() { workerFn(); });
+}
+
+InputConfigWatcher::~InputConfigWatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  cv.notify_one();
+  worker.join();
+
+  delete pending.exchange(nullptr);
+  delete retired.exchange(nullptr);
+}
+
+InputConfigWatcher::Status InputConfigWatcher::status() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return currentStatus;
+}
+
+bool InputConfigWatcher::FileStamp::operator==(const FileStamp& other) const {
+  return exists == other.exists && size == other.size &&
+    writeTime.dwLowDateTime == other.writeTime.dwLowDateTime && writeTime.dwHighDateTime == other.writeTime.dwHighDateTime;
+}
+
+InputConfigWatcher::FileStamp InputConfigWatcher::stamp() const {
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if(!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) { return FileStamp{ false, FILETIME{}, 0 }; }
+  return FileStamp{ true, data.ftLastWriteTime, (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow };
+}
+
+void InputConfigWatcher::workerFn() {
+  FileStamp loaded = { false, FILETIME{}, 0 };
+  //starting out as the current stamp means a file that is already there loads straight away
+  FileStamp seen = stamp();
+
+  std::unique_lock<std::mutex> lock(mtx);
+  while(!stopping) {
+    lock.unlock();
+
+    //frees what the game thread retired since the last poll (see the class comment)
+    delete retired.exchange(nullptr, std::memory_order_acquire);
+
+    //An editor may still be writing the file when its stamp first changes, so a version is only read once
+    //the stamp has held still for a whole poll. A deleted file keeps the last configuration in place.
+    FileStamp current = stamp();
+    if(current.exists && current == seen && current != loaded && load()) { loaded = current; }
+    seen = current;
+
+    lock.lock();
+    cv.wait_for(lock, pollInterval, [this]() { return stopping; });
+  }
+}
+
+bool InputConfigWatcher::load() {
+  //the editor may be holding the file open, in which case it is tried again on the next poll
+  std::ifstream file(path);
+  if(!file) { return false; }
+
+  std::string error;
+  std::unique_ptr<InputConfig> config = InputConfig::parse(file, error);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if(config) { currentStatus.loads++; }
+    else { currentStatus.failures++; }
+    currentStatus.lastError = error;
+  }
+
+  //a version that the game thread never got around to taking is simply replaced
+  if(config) { delete pending.exchange(config.release(), std::memory_order_acq_rel); }
+  return true;
+}
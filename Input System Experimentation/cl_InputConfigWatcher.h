@@ -0,0 +1,74 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "cl_InputConfig.h"
+
+//Watches an InputConfig file on a background thread, and parses and validates every new version of it
+//there, so that the game thread only ever receives finished configurations.
+//Handing them over is lock-free. A finished configuration goes in the 'pending' slot for take(), and
+//configurations the game thread is done with come back through the 'retired' slot so that they are usually
+//freed on the watcher thread. Both slots are only ever exchanged, never stored over, so nothing leaks: a
+//version that was never taken is freed by the watcher when it replaces it, and if the game thread retires a
+//configuration before the watcher has emptied the slot, retire() frees the one still sitting there itself.
+class InputConfigWatcher {
+public:
+  struct Status {
+    //versions that were parsed successfully and that were rejected
+    uint32_t loads;
+    uint32_t failures;
+    //why the latest version was rejected - empty if it loaded
+    std::string lastError;
+  };
+
+  //the file doesn't have to exist yet - it is loaded whenever it appears
+  InputConfigWatcher(const std::string& path, unsigned int pollMS = DEFAULT_POLL_MS);
+  ~InputConfigWatcher();
+
+  InputConfigWatcher(const InputConfigWatcher&) = delete;
+  void operator=(const InputConfigWatcher&) = delete;
+
+  //Game thread. take() returns the newest configuration that hasn't been taken yet, or null. The caller
+  //owns it until it passes it to retire(). Retiring usually defers the delete to the watcher thread, but
+  //it deletes on the calling thread when an earlier configuration is still waiting to be freed.
+  const InputConfig* take() { return pending.exchange(nullptr, std::memory_order_acquire); }
+  void retire(const InputConfig* config) { delete retired.exchange(config, std::memory_order_acq_rel); }
+
+  //locks, so it is meant for tools and logging rather than for every frame
+  Status status() const;
+
+private:
+  static constexpr unsigned int DEFAULT_POLL_MS = 250;
+
+  const std::string path;
+  const std::chrono::milliseconds pollInterval;
+
+  std::atomic<const InputConfig*> pending{ nullptr };
+  std::atomic<const InputConfig*> retired{ nullptr };
+
+  mutable std::mutex mtx;
+  std::condition_variable cv;
+  bool stopping = false;
+  Status currentStatus = { 0, 0, std::string() };
+
+  std::thread worker;
+
+  struct FileStamp {
+    bool exists;
+    FILETIME writeTime;
+    uint64_t size;
+    bool operator==(const FileStamp& other) const;
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+  };
+  FileStamp stamp() const;
+
+  void workerFn();
+  //returns false if the file couldn't be read, in which case it is tried again on the next poll
+  bool load();
+
+};
@@ -0,0 +1,100 @@
+#include "cl_InputDigest.h"
+#include "ns_Utility.h"
+
+namespace {
+  //the splitmix64 finalizer - every input bit affects every output bit
+  uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  //axis and edge terms are hashed from different ranges of keys than button terms, so none of them collide
+  constexpr uint64_t AXIS_KEY    = uint64_t(1) << 48;
+  constexpr uint64_t TRIGGER_KEY = uint64_t(1) << 49;
+  constexpr uint64_t RELEASE_KEY = uint64_t(1) << 50;
+}
+
+InputDigest::InputDigest(const InputFrame& frame) : mirror(frame) {
+  digest.frameNumber = frame.frameNumber;
+  digest.state = of(frame);
+  digest.edges = 0;
+  digest.chain = link(0, frame.frameNumber, digest.state, digest.edges);
+}
+
+void InputDigest::update(uint32_t frameNumber, const Input::DeviceState& keyboard, const Input::DeviceState& mouse, const Input::DeviceState& gamepad) {
+  digest.edges = 0;
+  updateButtons(keyboard, InputFrame::KEYBOARD_BUTTON_OFFSET);
+  updateButtons(mouse, InputFrame::MOUSE_BUTTON_OFFSET);
+  updateButtons(gamepad, InputFrame::GAMEPAD_BUTTON_OFFSET);
+  updateAxes(mouse, InputFrame::MOUSE_AXIS_OFFSET, InputFrame::quantizeCount);
+  updateAxes(gamepad, InputFrame::GAMEPAD_AXIS_OFFSET, InputFrame::quantizeUnit);
+
+  mirror.frameNumber = frameNumber;
+  digest.frameNumber = frameNumber;
+  digest.chain = link(digest.chain, frameNumber, digest.state, digest.edges);
+}
+
+uint64_t InputDigest::of(const InputFrame& frame) {
+  uint64_t state = 0;
+  for(size_t word = 0; word < InputFrame::BUTTON_WORD_CT; word++) {
+    uint64_t held = frame.buttons[word];
+    while(held) {
+      state ^= buttonTerm(word * 64 + Utility::lowestSetBit(held));
+      held &= held - 1;
+    }
+  }
+  for(size_t i = 0; i < InputFrame::AXIS_CT; i++) { state ^= axisTerm(i, frame.axes[i]); }
+  return state;
+}
+
+uint64_t InputDigest::edgesOf(const std::array<uint64_t, InputFrame::BUTTON_WORD_CT>& triggered, const std::array<uint64_t, InputFrame::BUTTON_WORD_CT>& released) {
+  uint64_t edges = 0;
+  for(size_t word = 0; word < InputFrame::BUTTON_WORD_CT; word++) {
+    for(uint64_t bits = triggered[word]; bits; bits &= bits - 1) { edges ^= edgeTerm(word * 64 + Utility::lowestSetBit(bits), false); }
+    for(uint64_t bits = released[word]; bits; bits &= bits - 1) { edges ^= edgeTerm(word * 64 + Utility::lowestSetBit(bits), true); }
+  }
+  return edges;
+}
+
+uint64_t InputDigest::link(uint64_t chain, uint32_t frameNumber, uint64_t state, uint64_t edges) {
+  //edges are already an XOR of hashed terms, and a frame with none links the same as the state alone
+  return mix(chain ^ mix(state + frameNumber) ^ edges);
+}
+
+uint64_t InputDigest::buttonTerm(size_t bit) {
+  return mix(bit + 1);
+}
+
+uint64_t InputDigest::edgeTerm(size_t bit, bool released) {
+  return mix((released ? RELEASE_KEY : TRIGGER_KEY) | bit);
+}
+
+uint64_t InputDigest::axisTerm(size_t axis, int16_t value) {
+  //a centered axis contributes nothing, so the idle state digests to 0
+  if(value == 0) { return 0; }
+  return mix(AXIS_KEY | (uint64_t(axis) << 16) | static_cast<uint16_t>(value));
+}
+
+void InputDigest::updateButtons(const Input::DeviceState& state, size_t bitOffset) {
+  //The list also has buttons that only repeated, which leave everything as it was. A tap within the frame
+  //leaves 'held' as it was too, so it only shows up in the edges.
+  for(size_t i : state.changedButtons) {
+    size_t bit = bitOffset + i;
+    if(state.buttons[i].triggered) { digest.edges ^= edgeTerm(bit, false); }
+    if(state.buttons[i].released)  { digest.edges ^= edgeTerm(bit, true); }
+    if(state.buttons[i].held == mirror.held(bit)) { continue; }
+    mirror.setHeld(bit, state.buttons[i].held);
+    digest.state ^= buttonTerm(bit);
+  }
+}
+
+void InputDigest::updateAxes(const Input::DeviceState& state, size_t axisOffset, int16_t (*quantize)(float)) {
+  for(size_t i : state.changedAxes) {
+    int16_t& value = mirror.axes[axisOffset + i];
+    int16_t quantized = quantize(state.axes[i]);
+    if(quantized == value) { continue; }
+    digest.state ^= axisTerm(axisOffset + i, value) ^ axisTerm(axisOffset + i, quantized);
+    value = quantized;
+  }
+}
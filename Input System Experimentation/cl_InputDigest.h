@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Running digest of the merged input in its canonical InputFrame form (held bits and quantized axes), so
+//that lockstep peers can confirm they fed the simulation the same input on every tick (see
+//Input::enableDigest()).
+//The state digest is the XOR of one hashed term per held button and per nonzero axis. Each update only
+//toggles the terms of the controls in changedButtons and changedAxes, so it costs a few operations per
+//change no matter how big the devices are. Each frame's state and button edges are also folded into a
+//chain, so comparing one chain value covers every frame since the digest started - including taps that
+//began and ended within a frame, which never show up in the held state.
+//Everything is integer arithmetic on the quantized values, so every peer computes the same digests, and
+//of() and edgesOf() give the same digests for a frame received from a peer, as long as it carries its
+//edges (as InputBroadcast::Frame does).
+class InputDigest {
+public:
+  struct Digest {
+    uint32_t frameNumber;
+    //the input as of this frame
+    uint64_t state;
+    //the buttons that triggered or released during this frame
+    uint64_t edges;
+    //every frame's number and state since the digest started, this one included
+    uint64_t chain;
+  };
+
+  //starts from 'frame', with the chain beginning at it
+  explicit InputDigest(const InputFrame& frame);
+
+  //folds in the frame the merged devices have just updated to
+  void update(uint32_t frameNumber, const Input::DeviceState& keyboard, const Input::DeviceState& mouse, const Input::DeviceState& gamepad);
+
+  const Digest& current() const { return digest; }
+
+  //the state digest of a whole frame, computed from scratch
+  static uint64_t of(const InputFrame& frame);
+
+  //the edge digest of a frame's triggered and released buttons, in the InputFrame bit layout
+  static uint64_t edgesOf(const std::array<uint64_t, InputFrame::BUTTON_WORD_CT>& triggered, const std::array<uint64_t, InputFrame::BUTTON_WORD_CT>& released);
+
+  //the chain value after folding in a frame
+  static uint64_t link(uint64_t chain, uint32_t frameNumber, uint64_t state, uint64_t edges);
+
+private:
+  Digest digest;
+
+  //the held bits and quantized axes the state digest currently describes
+  InputFrame mirror;
+
+  static uint64_t buttonTerm(size_t bit);
+  static uint64_t edgeTerm(size_t bit, bool released);
+  static uint64_t axisTerm(size_t axis, int16_t value);
+
+  void updateButtons(const Input::DeviceState& state, size_t bitOffset);
+  void updateAxes(const Input::DeviceState& state, size_t axisOffset, int16_t (*quantize)(float));
+
+};
@@ -0,0 +1,126 @@
+#include "cl_InputExporter.h"
+#include <stdexcept>
+
+InputExporter::InputExporter(Input& input, const std::wstring& pipeName) : input(input) {
+  //big enough that writes only wait on the client when it has fallen well behind
+  constexpr DWORD PIPE_BUFFER_SIZE = 64 * 1024;
+
+  pipe = CreateNamedPipeW(pipeName.c_str(),
+    PIPE_ACCESS_OUTBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+    PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+    1, PIPE_BUFFER_SIZE, 0, 0, nullptr);
+  if(pipe == INVALID_HANDLE_VALUE) { throw std::runtime_error("Failed to create input export pipe."); }
+
+  //overlapped pipe operations need a manual-reset event
+  ioEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if(!ioEvent) {
+    CloseHandle(pipe);
+    throw std::runtime_error("Failed to create input export event.");
+  }
+
+  worker = std::thread([this]() { workerFn(); });
+  frameSubscription = input.subscribeFrame([this]() { queueFrame(); });
+}
+
+InputExporter::~InputExporter() {
+  input.unsubscribe(frameSubscription);
+
+  stopping = true;
+  worker.join();
+
+  CloseHandle(ioEvent);
+  CloseHandle(pipe);
+}
+
+void InputExporter::queueFrame() {
+  //nothing is queued while nobody is listening, and the first frame after a client connects is always sent
+  if(!connected) {
+    anyQueued = false;
+    return;
+  }
+
+  input.captureFrame(captured);
+
+  //frames with nothing new are skipped - the codec's frame number gap tells the client how many
+  if(anyQueued && captured.sameInput(lastQueued)) { return; }
+
+  if(!frames.push(captured)) {
+    dropped++;
+    return;
+  }
+  lastQueued = captured;
+  anyQueued = true;
+}
+
+void InputExporter::workerFn() {
+  OVERLAPPED overlapped = {};
+  overlapped.hEvent = ioEvent;
+
+  InputFrame frame;
+  InputFrame sent;
+  bool sentAny = false;
+  uint8_t packet[2 + InputCodec::MAX_ENCODED_SIZE];
+
+  while(!stopping) {
+    if(!connected) {
+      ResetEvent(ioEvent);
+      bool accepted = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+      DWORD error = accepted ? ERROR_SUCCESS : GetLastError();
+      if(error == ERROR_IO_PENDING) { accepted = finishIO(overlapped); }
+      else if(error == ERROR_PIPE_CONNECTED) { accepted = true; }
+
+      if(!accepted) {
+        //e.g. a client that connected and closed again before being accepted
+        DisconnectNamedPipe(pipe);
+        Sleep(IDLE_WAIT_MS);
+        continue;
+      }
+
+      //anything queued while connecting predates the client's baseline
+      while(frames.pop(frame)) {}
+      sentAny = false;
+      connected = true;
+      continue;
+    }
+
+    if(!frames.pop(frame)) {
+      Sleep(IDLE_WAIT_MS);
+      continue;
+    }
+
+    size_t size = InputCodec::encode(frame, sentAny ? &sent : nullptr, packet + 2, InputCodec::MAX_ENCODED_SIZE);
+    packet[0] = static_cast<uint8_t>(size);
+    packet[1] = static_cast<uint8_t>(size >> 8);
+
+    ResetEvent(ioEvent);
+    bool written = WriteFile(pipe, packet, static_cast<DWORD>(size + 2), nullptr, &overlapped) != FALSE;
+    if(!written && GetLastError() == ERROR_IO_PENDING) { written = finishIO(overlapped); }
+
+    if(!written) {
+      //the client went away - wait for the next one
+      DisconnectNamedPipe(pipe);
+      connected = false;
+      continue;
+    }
+
+    sent = frame;
+    sentAny = true;
+  }
+
+  connected = false;
+}
+
+bool InputExporter::finishIO(OVERLAPPED& overlapped) {
+  //polled so that a client that never connects or never reads can't hold up shutdown
+  while(WaitForSingleObject(ioEvent, IDLE_WAIT_MS) == WAIT_TIMEOUT) {
+    if(stopping) {
+      CancelIoEx(pipe, &overlapped);
+      DWORD transferred;
+      GetOverlappedResult(pipe, &overlapped, &transferred, TRUE);
+      return false;
+    }
+  }
+
+  DWORD transferred;
+  return GetOverlappedResult(pipe, &overlapped, &transferred, FALSE) != FALSE;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "cl_Input.h"
+#include "cl_SpscRing.h"
+#include "cl_InputCodec.h"
+
+//Streams the merged input state out of process, so that an external viewer or recorder can watch live
+//input without an overlay eating into the frame.
+//After every Input::update() the frame is captured (see InputFrame) and, if it differs from the last one,
+//copied into a lock-free queue - that copy is all the game thread pays. A worker thread owns a local named
+//pipe and writes each queued frame to the connected client as a little-endian uint16 length followed by an
+//InputCodec packet. The first packet after a client connects is a keyframe, and each later one is a delta
+//against the packet before it.
+//Nothing is captured while no client is connected, and frames are dropped if the client falls behind.
+class InputExporter {
+public:
+  static constexpr const wchar_t* DEFAULT_PIPE_NAME = L"\\\\.\\pipe\\InputSystemExport";
+
+  //throws if the pipe can't be created (e.g. another exporter already owns the name)
+  InputExporter(Input& input, const std::wstring& pipeName = DEFAULT_PIPE_NAME);
+  ~InputExporter();
+
+  InputExporter(const InputExporter&) = delete;
+  void operator=(const InputExporter&) = delete;
+
+  bool clientConnected() const { return connected; }
+
+  //frames that didn't fit in the queue
+  uint64_t droppedFrames() const { return dropped; }
+
+private:
+  //a couple of seconds of frames at 60Hz, for a client that stalls briefly
+  static constexpr size_t QUEUE_CAPACITY = 128;
+
+  //how long the worker sleeps when there is nothing to do
+  static constexpr DWORD IDLE_WAIT_MS = 1;
+
+  Input& input;
+  Input::SubscriptionID frameSubscription;
+
+  //only touched by the game thread
+  InputFrame captured;
+  InputFrame lastQueued;
+  bool anyQueued = false;
+
+  SpscRing<InputFrame, QUEUE_CAPACITY> frames;
+  std::atomic<uint64_t> dropped{ 0 };
+  std::atomic<bool> connected{ false };
+  std::atomic<bool> stopping{ false };
+
+  HANDLE pipe;
+  HANDLE ioEvent;
+  std::thread worker;
+
+  void queueFrame();
+  void workerFn();
+
+  //waits for the pending overlapped operation - returns false if it failed or the exporter is stopping
+  bool finishIO(OVERLAPPED& overlapped);
+
+};
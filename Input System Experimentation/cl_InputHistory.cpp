@@ -0,0 +1,58 @@
+#include "cl_InputHistory.h"
+#include <stdexcept>
+
+InputHistory::InputHistory(size_t capacity) {
+  if(capacity == 0 || capacity > (size_t(1) << 31)) { throw std::runtime_error("Invalid InputHistory capacity."); }
+
+  size_t roundedCapacity = 1;
+  while(roundedCapacity < capacity) { roundedCapacity <<= 1; }
+  frames.resize(roundedCapacity);
+}
+
+void InputHistory::push(const InputFrame& frame) {
+  if(count > 0 && frame.frameNumber != newest + 1) {
+    count = 0;
+    dirty = false;
+  }
+
+  frames[slot(frame.frameNumber)] = frame;
+  newest = frame.frameNumber;
+  if(count < frames.size()) { count++; }
+
+  //a correction that has been evicted can no longer be resimulated from
+  if(dirty && !contains(dirtyFrom)) { dirtyFrom = oldestFrame(); }
+}
+
+const InputFrame* InputHistory::find(uint32_t frameNumber) const {
+  if(!contains(frameNumber)) { return nullptr; }
+  return &frames[slot(frameNumber)];
+}
+
+bool InputHistory::correct(const InputFrame& frame) {
+  if(!contains(frame.frameNumber)) { return false; }
+
+  frames[slot(frame.frameNumber)] = frame;
+
+  //comparing distances from the newest frame keeps this correct across frame number wraparound
+  if(!dirty || newest - frame.frameNumber > newest - dirtyFrom) { dirtyFrom = frame.frameNumber; }
+  dirty = true;
+  return true;
+}
+
+bool InputHistory::edges(uint32_t frameNumber, FrameEdges& out) const {
+  const InputFrame* frame = find(frameNumber);
+  if(!frame) { return false; }
+
+  const InputFrame* prev = find(frameNumber - 1);
+  for(size_t i = 0; i < InputFrame::BUTTON_WORD_CT; i++) {
+    uint64_t prevHeld = prev ? prev->buttons[i] : 0;
+    out.triggered[i] = frame->buttons[i] & ~prevHeld;
+    out.released[i]  = prevHeld & ~frame->buttons[i];
+  }
+  return true;
+}
+
+bool InputHistory::contains(uint32_t frameNumber) const {
+  //unsigned distance from the newest frame, so frames "in the future" come out huge and fail the test
+  return count > 0 && newest - frameNumber < count;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "st_InputFrame.h"
+
+//Fixed-capacity ring of the most recent InputFrames, for rollback and client-side prediction.
+//Frames are looked up by frame number in O(1). A past frame can be corrected (e.g. when the real remote
+//input arrives for a frame that was predicted), after which resimulate() walks forward from the oldest
+//corrected frame with the re-derived edges for each frame.
+//All storage is allocated by the constructor: capacity * sizeof(InputFrame) bytes, with the capacity
+//rounded up to a power of two so that slots stay consistent when frame numbers wrap around.
+class InputHistory {
+public:
+  //triggered/released bits for one frame, derived from it and the frame before it
+  struct FrameEdges {
+    std::array<uint64_t, InputFrame::BUTTON_WORD_CT> triggered;
+    std::array<uint64_t, InputFrame::BUTTON_WORD_CT> released;
+  };
+
+  explicit InputHistory(size_t capacity);
+
+  size_t capacity() const { return frames.size(); }
+  bool empty() const { return count == 0; }
+  uint32_t newestFrame() const { return newest; }
+  uint32_t oldestFrame() const { return newest - static_cast<uint32_t>(count) + 1; }
+
+  //Appends the next frame. If 'frame' does not follow the newest frame then the history is restarted from it.
+  //The oldest frame is evicted once the ring is full.
+  void push(const InputFrame& frame);
+
+  //returns null if the frame was never recorded or has been evicted
+  const InputFrame* find(uint32_t frameNumber) const;
+
+  //Overwrites a recorded frame and marks it for resimulation. Returns false if the frame is not in the history.
+  //Frames after it are left as they were - correct them too if they were predicted from the frame being replaced.
+  bool correct(const InputFrame& frame);
+
+  //Derives the edges for a recorded frame. The oldest frame has no predecessor, so all of its held buttons count as triggered.
+  bool edges(uint32_t frameNumber, FrameEdges& out) const;
+
+  bool needsResimulation() const { return dirty; }
+  uint32_t oldestCorrectedFrame() const { return dirtyFrom; }
+
+  //Calls 'fn(const InputFrame&, const FrameEdges&)' for every frame from the oldest corrected frame through
+  //the newest frame, in order, then clears the correction marker. Does nothing if nothing was corrected.
+  template<typename Fn>
+  void resimulate(Fn fn) {
+    if(!dirty) { return; }
+
+    FrameEdges frameEdges;
+    for(uint32_t frameNumber = dirtyFrom; frameNumber != newest + 1; frameNumber++) {
+      edges(frameNumber, frameEdges);
+      fn(*find(frameNumber), frameEdges);
+    }
+    dirty = false;
+  }
+
+private:
+  std::vector<InputFrame> frames;
+  size_t count = 0;
+  uint32_t newest = 0;
+
+  bool dirty = false;
+  uint32_t dirtyFrom = 0;
+
+  bool contains(uint32_t frameNumber) const;
+  size_t slot(uint32_t frameNumber) const { return frameNumber & (frames.size() - 1); }
+
+};
@@ -0,0 +1,101 @@
+#include "cl_InputLayers.h"
+#include <stdexcept>
+
+namespace {
+  const Input::DeviceButton IDLE_BUTTON;
+}
+
+InputLayers::InputLayers(const Input& input) : input(input), maskFrame(input.frameNumber()) {
+  layers[0] = Layer{};
+}
+
+InputLayers::LayerID InputLayers::push() {
+  if(depth == MAX_LAYERS) { throw std::runtime_error("Too many input layers."); }
+
+  //nothing is above the new layer yet, so nothing is blocked from it
+  layers[depth] = Layer{};
+  return depth++;
+}
+
+void InputLayers::pop() {
+  if(depth == 1) { throw std::runtime_error("The bottom input layer cannot be popped."); }
+  depth--;
+}
+
+void InputLayers::consumeButton(LayerID layer, Input::DeviceType device, size_t button) {
+  checkLayer(layer);
+  refreshFrame();
+
+  size_t bit = Input::controlBit(device, button);
+  uint64_t mask = uint64_t(1) << (bit % 64);
+  for(size_t i = 0; i < layer; i++) { layers[i].blockedButtons[bit / 64] |= mask; }
+}
+
+void InputLayers::consumeAxis(LayerID layer, Input::DeviceType device, size_t axis) {
+  checkLayer(layer);
+  refreshFrame();
+
+  uint32_t mask = 1u << Input::axisIndex(device, axis);
+  for(size_t i = 0; i < layer; i++) { layers[i].blockedAxes |= mask; }
+}
+
+void InputLayers::consumeAll(LayerID layer) {
+  checkLayer(layer);
+  refreshFrame();
+
+  for(size_t i = 0; i < layer; i++) {
+    layers[i].blockedButtons.fill(~uint64_t(0));
+    layers[i].blockedAxes = ~0u;
+  }
+}
+
+bool InputLayers::visible(LayerID layer, Input::DeviceType device, size_t button) const {
+  checkLayer(layer);
+  if(!current()) { return true; }
+
+  size_t bit = Input::controlBit(device, button);
+  return !((layers[layer].blockedButtons[bit / 64] >> (bit % 64)) & 1);
+}
+
+const Input::DeviceButton& InputLayers::button(LayerID layer, Input::DeviceType device, size_t button) const {
+  return visible(layer, device, button) ? input.state(device).buttons[button] : IDLE_BUTTON;
+}
+
+float InputLayers::axis(LayerID layer, Input::DeviceType device, size_t axis) const {
+  checkLayer(layer);
+  if(current() && ((layers[layer].blockedAxes >> Input::axisIndex(device, axis)) & 1)) { return 0; }
+  return input.state(device).axes[axis];
+}
+
+Input::ButtonWords InputLayers::held(LayerID layer, Input::DeviceType device) const {
+  return visibleWords(layer, input.heldWords(), device);
+}
+
+Input::ButtonWords InputLayers::triggered(LayerID layer, Input::DeviceType device) const {
+  return visibleWords(layer, input.triggeredWords(), device);
+}
+
+void InputLayers::refreshFrame() {
+  if(current()) { return; }
+
+  for(size_t i = 0; i < depth; i++) { layers[i] = Layer{}; }
+  maskFrame = input.frameNumber();
+}
+
+void InputLayers::checkLayer(LayerID layer) const {
+  //layers at or above 'depth' hold masks from before they were popped, or nothing at all
+  if(layer >= depth) { throw std::runtime_error("Input layer is not on the stack."); }
+}
+
+Input::ButtonWords InputLayers::visibleWords(LayerID layer, const Input::ButtonWords& words, Input::DeviceType device) const {
+  checkLayer(layer);
+  const Input::ButtonWords& mask = Input::deviceMask(device);
+  bool blocking = current();
+
+  Input::ButtonWords visibleBits;
+  for(size_t i = 0; i < InputFrame::BUTTON_WORD_CT; i++) {
+    visibleBits[i] = words[i] & mask[i];
+    if(blocking) { visibleBits[i] &= ~layers[layer].blockedButtons[i]; }
+  }
+  return visibleBits;
+}
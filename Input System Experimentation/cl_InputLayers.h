@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Stack of input contexts, where a higher layer can consume controls for the rest of the frame so that the
+//layers below it don't see them (e.g. an open menu hiding its key presses from gameplay).
+//Layer 0 is the bottom of the stack and always exists. Each layer keeps a mask of the controls consumed
+//by the layers above it, so a query is a single AND and no device state is ever copied.
+//Consumption lasts until the next Input::update().
+class InputLayers {
+public:
+  typedef size_t LayerID;
+  static constexpr size_t MAX_LAYERS = 16;
+
+  InputLayers(const Input& input);
+
+  //O(1) - returns the ID of the new top layer, throws if the stack is full
+  LayerID push();
+
+  //O(1) - anything the popped layer consumed stays consumed until the next update
+  void pop();
+
+  LayerID top() const { return depth - 1; }
+
+  //Hides a control from every layer below 'layer' for the rest of the frame. These and the queries below
+  //throw if 'layer' isn't on the stack (it was never pushed, or has been popped since).
+  void consumeButton(LayerID layer, Input::DeviceType device, size_t button);
+  void consumeAxis(LayerID layer, Input::DeviceType device, size_t axis);
+  void consumeAll(LayerID layer);
+
+  //the state as seen by 'layer' - consumed buttons read as idle and consumed axes read as zero
+  bool visible(LayerID layer, Input::DeviceType device, size_t button) const;
+  const Input::DeviceButton& button(LayerID layer, Input::DeviceType device, size_t button) const;
+  float axis(LayerID layer, Input::DeviceType device, size_t axis) const;
+
+  //One device's held or triggered buttons as seen by 'layer', in the InputFrame bit layout (see
+  //Input::heldWords()) - one AND per word.
+  Input::ButtonWords held(LayerID layer, Input::DeviceType device) const;
+  Input::ButtonWords triggered(LayerID layer, Input::DeviceType device) const;
+
+private:
+  struct Layer {
+    std::array<uint64_t, InputFrame::BUTTON_WORD_CT> blockedButtons;
+    uint32_t blockedAxes;
+  };
+
+  const Input& input;
+  std::array<Layer, MAX_LAYERS> layers;
+  size_t depth = 1;
+
+  //the frame the masks belong to - masks from an older frame are treated as empty
+  uint32_t maskFrame;
+
+  void refreshFrame();
+  bool current() const { return maskFrame == input.frameNumber(); }
+  void checkLayer(LayerID layer) const;
+  Input::ButtonWords visibleWords(LayerID layer, const Input::ButtonWords& words, Input::DeviceType device) const;
+
+};
@@ -0,0 +1,223 @@
+#include "cl_InputLoadGenerator.h"
+#include "ns_Utility.h"
+#include <chrono>
+#include <sstream>
+#include <algorithm>
+
+InputLoadGenerator::InputLoadGenerator(Input& input, const Config& config) :
+  input(input),
+  config(config),
+  rng(config.seed),
+  sourceDist({ config.keyboardWeight, config.mouseWeight, config.gamepadWeight }),
+  mergedKeys(InputFrame::KEYBOARD_BUTTON_CT),
+  mergedMouseButtons(InputFrame::MOUSE_BUTTON_CT),
+  mergedMouseAxes(InputFrame::MOUSE_AXIS_CT),
+  padButtons(InputFrame::GAMEPAD_BUTTON_CT)
+{
+  uintptr_t nextHandle = HANDLE_BASE;
+  for(size_t i = 0; i < config.keyboardCount; i++) {
+    keyboards.push_back(PhysicalModel{ reinterpret_cast<HANDLE>(nextHandle++), std::vector<bool>(InputFrame::KEYBOARD_BUTTON_CT), {} });
+  }
+  for(size_t i = 0; i < config.mouseCount; i++) {
+    mice.push_back(PhysicalModel{ reinterpret_cast<HANDLE>(nextHandle++), std::vector<bool>(InputFrame::MOUSE_BUTTON_CT), std::vector<float>(InputFrame::MOUSE_AXIS_CT) });
+  }
+
+  //Start from whatever the Input already reports, so that buttons left held by the real devices don't
+  //count against us. They act as an extra holder that never lets go.
+  auto seed = [](std::vector<ButtonModel>& models, const Input::DeviceState& state) {
+    for(size_t i = 0; i < models.size(); i++) {
+      models[i].held = state.buttons[i].held;
+      models[i].holders = models[i].held ? 1 : 0;
+    }
+  };
+  seed(mergedKeys, input.keyboard());
+  seed(mergedMouseButtons, input.mouse());
+  seed(padButtons, input.gamepad());
+  for(size_t i = 0; i < InputFrame::GAMEPAD_BUTTON_CT; i++) {
+    if(padButtons[i].held) { pad.wButtons |= Input::Gamepad::xinputBit(i); }
+  }
+
+  input.resetEventQueueHighWater();
+}
+
+void InputLoadGenerator::runFrame() {
+  beginFrame(mergedKeys);
+  beginFrame(mergedMouseButtons);
+  beginFrame(padButtons);
+  for(auto& axis : mergedMouseAxes) { axis = 0; }
+  for(auto& mouse : mice) {
+    for(auto& axis : mouse.axes) { axis = 0; }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  //keyboard and mouse events are timestamped by the update, but pad states carry their own times
+  uint64_t padTime = Utility::nowNS();
+  for(size_t i = 0; i < config.eventsPerFrame; i++) {
+    int source = sourceDist(rng);
+    if(source == 0 && !keyboards.empty()) { injectKeyboard(); }
+    if(source == 1 && !mice.empty()) { injectMouse(); }
+    if(source == 2) { injectGamepad(padTime++); }
+  }
+
+  //the pad is only driven by injection while states are pending, so keep it pinned every frame
+  input.injectGamepadState(pad, padTime);
+
+  input.update();
+
+  stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.frames++;
+  stats.eventsInjected += config.eventsPerFrame;
+  stats.eventsPerSecond = stats.seconds > 0 ? stats.eventsInjected / stats.seconds : 0;
+  stats.queueHighWater = input.eventQueueHighWater();
+
+  verify();
+}
+
+void InputLoadGenerator::injectKeyboard() {
+  auto& device = keyboards[rng() % keyboards.size()];
+
+  //VK 0 is not a key
+  size_t vk = 1 + rng() % (InputFrame::KEYBOARD_BUTTON_CT - 1);
+  bool press = std::bernoulli_distribution(config.pressChance)(rng);
+
+  RAWINPUT rin = {};
+  rin.header.dwType = RIM_TYPEKEYBOARD;
+  rin.header.hDevice = device.handle;
+  rin.data.keyboard.VKey = static_cast<USHORT>(vk);
+  rin.data.keyboard.Message = press ? WM_KEYDOWN : WM_KEYUP;
+  input.injectEvent(rin);
+
+  //a press while held models OS key repeat, which must not count as a trigger
+  if(press) { physicalPress(device, mergedKeys, vk); }
+  else      { physicalRelease(device, mergedKeys, vk); }
+}
+
+void InputLoadGenerator::injectMouse() {
+  auto& device = mice[rng() % mice.size()];
+  std::uniform_int_distribution<LONG> deltaDist(-config.maxMouseDelta, config.maxMouseDelta);
+
+  RAWINPUT rin = {};
+  rin.header.dwType = RIM_TYPEMOUSE;
+  rin.header.hDevice = device.handle;
+  rin.data.mouse.lLastX = deltaDist(rng);
+  rin.data.mouse.lLastY = deltaDist(rng);
+
+  //most mouse events are pure motion
+  if(rng() % 4 == 0) {
+    size_t button = rng() % InputFrame::MOUSE_BUTTON_CT;
+    bool press = std::bernoulli_distribution(config.pressChance)(rng);
+    rin.data.mouse.usButtonFlags = static_cast<USHORT>(1 << (button * 2 + (press ? 0 : 1)));
+
+    if(press) { physicalPress(device, mergedMouseButtons, button); }
+    else      { physicalRelease(device, mergedMouseButtons, button); }
+  }
+
+  input.injectEvent(rin);
+
+  device.axes[Input::Mouse::DELTA_X] += rin.data.mouse.lLastX;
+  device.axes[Input::Mouse::DELTA_Y] += rin.data.mouse.lLastY;
+  mergedMouseAxes[Input::Mouse::DELTA_X] += rin.data.mouse.lLastX;
+  mergedMouseAxes[Input::Mouse::DELTA_Y] += rin.data.mouse.lLastY;
+}
+
+void InputLoadGenerator::injectGamepad(uint64_t timeNS) {
+  size_t button = rng() % InputFrame::GAMEPAD_BUTTON_CT;
+  pad.wButtons ^= Input::Gamepad::xinputBit(button);
+  input.injectGamepadState(pad, timeNS);
+
+  auto& model = padButtons[button];
+  model.held = (pad.wButtons & Input::Gamepad::xinputBit(button)) != 0;
+  if(model.held) { model.triggered = true; }
+  else           { model.released = true; }
+}
+
+void InputLoadGenerator::physicalPress(PhysicalModel& device, std::vector<ButtonModel>& merged, size_t button) {
+  if(device.held[button]) { return; }
+  device.held[button] = true;
+
+  auto& model = merged[button];
+  if(model.holders++ == 0) {
+    model.held = true;
+    model.triggered = true;
+  }
+}
+
+void InputLoadGenerator::physicalRelease(PhysicalModel& device, std::vector<ButtonModel>& merged, size_t button) {
+  if(!device.held[button]) { return; }
+  device.held[button] = false;
+
+  auto& model = merged[button];
+  if(--model.holders == 0) {
+    model.held = false;
+    model.released = true;
+  }
+}
+
+void InputLoadGenerator::beginFrame(std::vector<ButtonModel>& buttons) {
+  for(auto& model : buttons) {
+    model.triggered = false;
+    model.released = false;
+  }
+}
+
+void InputLoadGenerator::verify() {
+  verifyButtons("keyboard", input.keyboard(), mergedKeys);
+  verifyButtons("mouse", input.mouse(), mergedMouseButtons);
+  verifyButtons("gamepad", input.gamepad(), padButtons);
+
+  for(size_t i = 0; i < InputFrame::MOUSE_AXIS_CT; i++) {
+    if(input.mouse().axes[i] != mergedMouseAxes[i]) { diverge("mouse axis " + std::to_string(i) + " has the wrong total"); }
+  }
+
+  //A device only gets a state once its first event arrives, so one that hasn't had any yet reads as idle.
+  for(auto& keyboard : keyboards) {
+    const Input::DeviceState* state = physicalState(Input::DeviceType::KEYBOARD, keyboard.handle);
+    for(size_t i = 0; i < InputFrame::KEYBOARD_BUTTON_CT; i++) {
+      bool held = state && state->buttons[i].held;
+      if(held != keyboard.held[i]) { diverge("physical keyboard key " + std::to_string(i) + " has the wrong held state"); }
+    }
+  }
+
+  for(auto& mouse : mice) {
+    const Input::DeviceState* state = physicalState(Input::DeviceType::MOUSE, mouse.handle);
+    for(size_t i = 0; i < InputFrame::MOUSE_BUTTON_CT; i++) {
+      bool held = state && state->buttons[i].held;
+      if(held != mouse.held[i]) { diverge("physical mouse button " + std::to_string(i) + " has the wrong held state"); }
+    }
+    for(size_t i = 0; i < InputFrame::MOUSE_AXIS_CT; i++) {
+      float total = state ? state->axes[i] : 0;
+      if(total != mouse.axes[i]) { diverge("physical mouse axis " + std::to_string(i) + " has the wrong total"); }
+    }
+  }
+}
+
+const Input::DeviceState* InputLoadGenerator::physicalState(Input::DeviceType type, Input::DeviceID id) const {
+  auto& ids = input.physicalDevices(type);
+  if(std::find(ids.begin(), ids.end(), id) == ids.end()) { return nullptr; }
+  return &input.physicalDevice(id);
+}
+
+void InputLoadGenerator::verifyButtons(const char* name, const Input::DeviceState& state, const std::vector<ButtonModel>& expected) {
+  size_t heldCt = 0;
+  for(size_t i = 0; i < expected.size(); i++) {
+    auto& btn = state.buttons[i];
+    auto& model = expected[i];
+    if(model.held) { heldCt++; }
+
+    //several presses of one button in a frame still only trigger once
+    bool match = btn.held == model.held && btn.triggered == model.triggered && btn.released == model.released;
+    if(!match) {
+      std::ostringstream ss;
+      ss << name << " button " << i << " expected held/triggered/released " << model.held << model.triggered << model.released
+         << " but got " << btn.held << btn.triggered << btn.released << " (frame " << stats.frames << ")";
+      diverge(ss.str());
+    }
+  }
+
+  if(state.heldCount != heldCt) { diverge(std::string(name) + " held count is wrong"); }
+}
+
+void InputLoadGenerator::diverge(const std::string& what) {
+  if(stats.divergences++ == 0) { stats.firstDivergence = what; }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <Windows.h>
+#include <Xinput.h>
+#include <random>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Floods an Input with seeded random keyboard, mouse and gamepad events through its injection entry points,
+//and checks the resulting states against a simple reference model after every update. Used for soak
+//testing: any dropped, reordered or double-counted event shows up as a divergence.
+//The merged keyboard/mouse states are checked too, so leave the real devices alone while it runs.
+class InputLoadGenerator {
+public:
+  struct Config {
+    uint32_t seed = 1;
+    size_t eventsPerFrame = 10000;
+
+    //relative weights of the event sources
+    double keyboardWeight = 1;
+    double mouseWeight = 1;
+    double gamepadWeight = 0.1;
+
+    //number of simulated physical devices
+    size_t keyboardCount = 2;
+    size_t mouseCount = 2;
+
+    //chance that a keyboard/mouse button event is a press rather than a release
+    double pressChance = 0.5;
+
+    //largest mouse delta per event on each axis
+    LONG maxMouseDelta = 8;
+  };
+
+  struct Report {
+    uint64_t frames = 0;
+    uint64_t eventsInjected = 0;
+    double seconds = 0;
+    double eventsPerSecond = 0;
+    size_t queueHighWater = 0;
+    uint64_t divergences = 0;
+
+    //description of the first divergence, empty if there were none
+    std::string firstDivergence;
+  };
+
+  InputLoadGenerator(Input& input, const Config& config);
+
+  //injects one frame's worth of events, updates the Input and verifies the result
+  void runFrame();
+
+  const Report& report() const { return stats; }
+
+private:
+  //first fake device handle - far from anything the OS hands out
+  static constexpr uintptr_t HANDLE_BASE = 0x5EED0000;
+
+  //per-button expectations for one frame
+  struct ButtonModel {
+    bool held = false;
+    bool triggered = false;
+    bool released = false;
+    unsigned int holders = 0;
+  };
+
+  struct PhysicalModel {
+    HANDLE handle;
+    std::vector<bool> held;
+    std::vector<float> axes;
+  };
+
+  Input& input;
+  Config config;
+  std::mt19937 rng;
+  std::discrete_distribution<int> sourceDist;
+  Report stats;
+
+  std::vector<PhysicalModel> keyboards;
+  std::vector<PhysicalModel> mice;
+  std::vector<ButtonModel> mergedKeys;
+  std::vector<ButtonModel> mergedMouseButtons;
+  std::vector<float> mergedMouseAxes;
+  std::vector<ButtonModel> padButtons;
+  XINPUT_GAMEPAD pad = {};
+
+  void injectKeyboard();
+  void injectMouse();
+  void injectGamepad(uint64_t timeNS);
+
+  void physicalPress(PhysicalModel& device, std::vector<ButtonModel>& merged, size_t button);
+  void physicalRelease(PhysicalModel& device, std::vector<ButtonModel>& merged, size_t button);
+  static void beginFrame(std::vector<ButtonModel>& buttons);
+
+  void verify();
+  void verifyButtons(const char* name, const Input::DeviceState& state, const std::vector<ButtonModel>& expected);
+  //null if the device hasn't had an event yet
+  const Input::DeviceState* physicalState(Input::DeviceType type, Input::DeviceID id) const;
+  void diverge(const std::string& what);
+
+};
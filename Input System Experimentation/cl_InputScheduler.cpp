@@ -0,0 +1,214 @@
+#include "cl_InputScheduler.h"
+#include "ns_Utility.h"
+#include <stdexcept>
+
+InputScheduler::InputScheduler(Input& input) : input(input) {
+  for(Input::DeviceType type : { Input::DeviceType::KEYBOARD, Input::DeviceType::MOUSE, Input::DeviceType::GAMEPAD }) {
+    buttonWaiters[static_cast<size_t>(type)].resize(input.state(type).buttons.size());
+  }
+  waiterCounts.fill(0);
+
+  frameSubscription = input.subscribeFrame([this]() { update(); });
+}
+
+InputScheduler::~InputScheduler() {
+  input.unsubscribe(frameSubscription);
+
+  //destroying a script cancels the wait it is suspended on
+  for(auto handle : scripts) { handle.destroy(); }
+}
+
+void InputScheduler::run(Script script) {
+  Script::Handle handle = script.handle;
+  script.handle = nullptr;
+
+  handle.promise().slot = scripts.size();
+  scripts.push_back(handle);
+
+  //a script that never waited has already finished
+  if(handle.done()) {
+    auto exception = release(handle);
+    if(exception) { std::rethrow_exception(exception); }
+  }
+}
+
+std::exception_ptr InputScheduler::takeFailure() {
+  if(failures.empty()) { return nullptr; }
+  auto exception = failures.front();
+  failures.erase(failures.begin());
+  return exception;
+}
+
+InputScheduler::Wait InputScheduler::pressed(Input::DeviceType device, size_t button) {
+  if(button >= input.state(device).buttons.size()) { throw std::runtime_error("Invalid button."); }
+
+  Wait wait(*this);
+  wait.conditions[wait.conditionCt++] = Wait::Condition{ Wait::Kind::PRESSED, device, button, 0 };
+  return wait;
+}
+
+InputScheduler::Wait InputScheduler::released(Input::DeviceType device, size_t button) {
+  if(button >= input.state(device).buttons.size()) { throw std::runtime_error("Invalid button."); }
+
+  Wait wait(*this);
+  wait.conditions[wait.conditionCt++] = Wait::Condition{ Wait::Kind::RELEASED, device, button, 0 };
+  return wait;
+}
+
+InputScheduler::Wait InputScheduler::heldFor(Input::DeviceType device, size_t button, unsigned int milliseconds) {
+  if(button >= input.state(device).buttons.size()) { throw std::runtime_error("Invalid button."); }
+
+  Wait wait(*this);
+  wait.conditions[wait.conditionCt++] = Wait::Condition{ Wait::Kind::HELD_FOR, device, button, milliseconds * Utility::NS_PER_MS };
+  return wait;
+}
+
+InputScheduler::Wait InputScheduler::anyOf(std::initializer_list<Wait> waits) {
+  Wait combined(*this);
+  for(auto& wait : waits) {
+    if(combined.conditionCt + wait.conditionCt > MAX_CONDITIONS) { throw std::runtime_error("Too many conditions in anyOf()."); }
+    for(size_t i = 0; i < wait.conditionCt; i++) { combined.conditions[combined.conditionCt++] = wait.conditions[i]; }
+  }
+  return combined;
+}
+
+void InputScheduler::suspend(Wait& wait, Script::Handle handle) {
+  wait.waiting = handle;
+  wait.fired = false;
+
+  uint64_t now = input.frameTimeNS();
+  for(size_t i = 0; i < wait.conditionCt; i++) {
+    auto& cond = wait.conditions[i];
+    size_t type = static_cast<size_t>(cond.device);
+    buttonWaiters[type][cond.button].push_back(Waiter{ &wait, i });
+    waiterCounts[type]++;
+
+    //a button that is already down counts from now
+    if(cond.kind == Wait::Kind::HELD_FOR && input.state(cond.device).buttons[cond.button].held) { arm(wait, i, now); }
+  }
+}
+
+void InputScheduler::cancel(Wait& wait) {
+  for(size_t i = 0; i < wait.conditionCt; i++) {
+    auto& cond = wait.conditions[i];
+    size_t type = static_cast<size_t>(cond.device);
+    auto& list = buttonWaiters[type][cond.button];
+    for(size_t j = 0; j < list.size(); j++) {
+      if(list[j].wait == &wait && list[j].condition == i) {
+        list[j] = list.back();
+        list.pop_back();
+        waiterCounts[type]--;
+        break;
+      }
+    }
+
+    if(cond.kind == Wait::Kind::HELD_FOR) { disarm(wait, i); }
+  }
+  wait.waiting = nullptr;
+}
+
+void InputScheduler::arm(Wait& wait, size_t condition, uint64_t nowNS) {
+  timers.push_back(Timer{ &wait, condition, nowNS + wait.conditions[condition].durationNS });
+}
+
+void InputScheduler::disarm(Wait& wait, size_t condition) {
+  for(size_t i = 0; i < timers.size(); i++) {
+    if(timers[i].wait == &wait && timers[i].condition == condition) {
+      timers[i] = timers.back();
+      timers.pop_back();
+      return;
+    }
+  }
+}
+
+void InputScheduler::fire(Wait& wait, size_t condition) {
+  if(wait.fired) { return; }
+  wait.fired = true;
+  wait.firedCondition = condition;
+  ready.push_back(&wait);
+}
+
+void InputScheduler::update() {
+  uint64_t now = input.frameTimeNS();
+
+  for(Input::DeviceType type : { Input::DeviceType::KEYBOARD, Input::DeviceType::MOUSE, Input::DeviceType::GAMEPAD }) {
+    if(waiterCounts[static_cast<size_t>(type)] == 0) { continue; }
+
+    auto& devState = input.state(type);
+    auto& waiters = buttonWaiters[static_cast<size_t>(type)];
+    for(size_t index : devState.changedButtons) {
+      const Input::DeviceButton& btn = devState.buttons[index];
+      for(auto& waiter : waiters[index]) {
+        if(waiter.wait->fired) { continue; }
+        switch(waiter.wait->conditions[waiter.condition].kind) {
+        case Wait::Kind::PRESSED:
+          if(btn.triggered) { fire(*waiter.wait, waiter.condition); }
+          break;
+        case Wait::Kind::RELEASED:
+          if(btn.released) { fire(*waiter.wait, waiter.condition); }
+          break;
+        case Wait::Kind::HELD_FOR:
+          //a release restarts the hold, and a tap that began and ended during the frame never starts it
+          if(btn.released) { disarm(*waiter.wait, waiter.condition); }
+          if(btn.triggered && btn.held) { arm(*waiter.wait, waiter.condition, now); }
+          break;
+        }
+      }
+    }
+  }
+
+  for(auto& timer : timers) {
+    if(now >= timer.deadlineNS) { fire(*timer.wait, timer.condition); }
+  }
+
+  if(ready.empty()) { return; }
+
+  //Everything is unfiled before anything resumes, since the resumed scripts will file their next waits.
+  //The waits themselves are destroyed as their scripts resume, so only the handles are kept.
+  for(Wait* wait : ready) {
+    resuming.push_back(wait->waiting);
+    cancel(*wait);
+  }
+  ready.clear();
+
+  for(auto handle : resuming) {
+    handle.resume();
+    if(!handle.done()) { continue; }
+
+    auto exception = release(handle);
+    if(exception) { failures.push_back(exception); }
+  }
+  resuming.clear();
+}
+
+std::exception_ptr InputScheduler::release(Script::Handle handle) {
+  auto exception = handle.promise().exception;
+  size_t slot = handle.promise().slot;
+  scripts[slot] = scripts.back();
+  scripts[slot].promise().slot = slot;
+  scripts.pop_back();
+  handle.destroy();
+  return exception;
+}
+
+InputScheduler::Script& InputScheduler::Script::operator=(Script&& other) {
+  if(handle) { handle.destroy(); }
+  handle = other.handle;
+  other.handle = nullptr;
+  return *this;
+}
+
+InputScheduler::Script::~Script() {
+  if(handle) { handle.destroy(); }
+}
+
+void InputScheduler::Wait::await_suspend(Script::Handle handle) {
+  scheduler->suspend(*this, handle);
+}
+
+InputScheduler::Wait::Wait(const Wait& other) : scheduler(other.scheduler), conditions(other.conditions), conditionCt(other.conditionCt) {
+}
+
+InputScheduler::Wait::~Wait() {
+  if(waiting) { scheduler->cancel(*this); }
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
+#include <experimental/coroutine>
+#include "cl_Input.h"
+
+//Runs input-driven scripts written as coroutines, so that a flow like "wait for A, then wait for RT to be
+//held for a second" reads top to bottom instead of being a per-frame state machine:
+//
+//  InputScheduler::Script tutorial(InputScheduler& s) {
+//    co_await s.pressed(Input::DeviceType::GAMEPAD, Input::Gamepad::A);
+//    co_await s.heldFor(Input::DeviceType::GAMEPAD, Input::Gamepad::RSHOULDER, 1000);
+//  }
+//  scheduler.run(tutorial(scheduler));
+//
+//Scripts are resumed from Input::update(). Waiters are filed under the control they wait on and only the
+//controls in changedButtons are looked at, so suspended scripts cost nothing while their controls are idle.
+//A wait always starts on the next update() - a press that happened earlier in the current frame does not count.
+//Times are frame times (Input::frameTimeNS()), so scripts behave the same when Input is updated with replayed times.
+class InputScheduler {
+public:
+  class Script;
+  class Wait;
+
+  InputScheduler(Input& input);
+  ~InputScheduler();
+  InputScheduler(const InputScheduler&) = delete;
+  InputScheduler& operator=(const InputScheduler&) = delete;
+
+  //Runs the script until its first co_await and takes ownership of it. Scripts that are still suspended
+  //when the scheduler is destroyed are destroyed with it. An exception thrown before the first co_await
+  //comes out of run().
+  void run(Script script);
+
+  //Exceptions thrown by scripts that Input::update() resumed are kept here instead of being thrown out of
+  //update(), where they would cut short the other subscribers. takeFailure() returns the oldest one and
+  //forgets it, or null if there are none.
+  std::exception_ptr takeFailure();
+  size_t failureCount() const { return failures.size(); }
+
+  //number of scripts that have not finished
+  size_t scriptCount() const { return scripts.size(); }
+
+  //The awaitables. co_await on anyOf() gives the index of the wait that finished it.
+  static constexpr size_t MAX_CONDITIONS = 8;
+  Wait pressed(Input::DeviceType device, size_t button);
+  Wait released(Input::DeviceType device, size_t button);
+  Wait heldFor(Input::DeviceType device, size_t button, unsigned int milliseconds);
+  Wait anyOf(std::initializer_list<Wait> waits);
+
+  class Script {
+  public:
+    struct promise_type {
+      size_t slot = 0;
+      std::exception_ptr exception;
+
+      Script get_return_object() { return Script(Handle::from_promise(*this)); }
+      std::experimental::suspend_never initial_suspend() { return {}; }
+      //finished scripts stay suspended so that their owner can destroy them
+      std::experimental::suspend_always final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { exception = std::current_exception(); }
+    };
+    typedef std::experimental::coroutine_handle<promise_type> Handle;
+
+    Script(Script&& other) : handle(other.handle) { other.handle = nullptr; }
+    Script& operator=(Script&& other);
+    Script(const Script&) = delete;
+    Script& operator=(const Script&) = delete;
+    ~Script();
+
+  private:
+    friend class InputScheduler;
+    explicit Script(Handle handle) : handle(handle) {}
+    Handle handle;
+
+  };
+
+  class Wait {
+  public:
+    bool await_ready() const { return false; }
+    void await_suspend(Script::Handle handle);
+    size_t await_resume() const { return firedCondition; }
+
+    Wait(const Wait& other);
+    ~Wait();
+
+  private:
+    friend class InputScheduler;
+    enum class Kind : uint8_t { PRESSED, RELEASED, HELD_FOR };
+    struct Condition {
+      Kind kind;
+      Input::DeviceType device;
+      size_t button;
+      uint64_t durationNS;
+    };
+
+    explicit Wait(InputScheduler& scheduler) : scheduler(&scheduler) {}
+    Wait& operator=(const Wait&) = delete;
+
+    InputScheduler* scheduler;
+    std::array<Condition, MAX_CONDITIONS> conditions;
+    size_t conditionCt = 0;
+
+    //set while the wait is filed with the scheduler
+    Script::Handle waiting;
+    size_t firedCondition = 0;
+    bool fired = false;
+
+  };
+
+private:
+  struct Waiter {
+    Wait* wait;
+    size_t condition;
+  };
+  struct Timer {
+    Wait* wait;
+    size_t condition;
+    uint64_t deadlineNS;
+  };
+
+  Input& input;
+  Input::SubscriptionID frameSubscription;
+
+  //indexed by DeviceType, then by button
+  std::array<std::vector<std::vector<Waiter>>, 3> buttonWaiters;
+  std::array<size_t, 3> waiterCounts;
+
+  //heldFor() conditions whose button is currently held
+  std::vector<Timer> timers;
+
+  std::vector<Script::Handle> scripts;
+  std::vector<Wait*> ready;
+  std::vector<Script::Handle> resuming;
+  std::vector<std::exception_ptr> failures;
+
+  void suspend(Wait& wait, Script::Handle handle);
+  void cancel(Wait& wait);
+  void arm(Wait& wait, size_t condition, uint64_t nowNS);
+  void disarm(Wait& wait, size_t condition);
+  void fire(Wait& wait, size_t condition);
+  void update();
+  //destroys a finished script, returning anything it threw
+  std::exception_ptr release(Script::Handle handle);
+
+};
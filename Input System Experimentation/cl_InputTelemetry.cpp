@@ -0,0 +1,54 @@
+#include "cl_InputTelemetry.h"
+#include "ns_Utility.h"
+#include <algorithm>
+
+InputTelemetry::InputTelemetry() {
+  reset();
+}
+
+size_t InputTelemetry::bucket(uint64_t durationNS) {
+  uint64_t ms = durationNS / Utility::NS_PER_MS;
+  if(ms == 0) { return 0; }
+  return (std::min)(static_cast<size_t>(Utility::highestSetBit(ms)) + 1, BUCKET_CT - 1);
+}
+
+void InputTelemetry::snapshot(Snapshot& out) {
+  uint64_t elapsedNS = frameTime - snapshotTime;
+  for(size_t i = 0; i < devices.size(); i++) {
+    uint64_t events = devices[i].events - snapshotEvents[i];
+    devices[i].eventsPerSecond = elapsedNS > 0 ? static_cast<double>(events) * Utility::NS_PER_SECOND / elapsedNS : 0;
+    snapshotEvents[i] = devices[i].events;
+  }
+  snapshotTime = frameTime;
+
+  out.devices = devices;
+  out.controls = controls;
+}
+
+void InputTelemetry::reset() {
+  devices.fill(DeviceStats{ 0, 0 });
+  controls.fill(ControlStats{ 0, Histogram{}, Histogram{} });
+  lastPressNS.fill(0);
+  snapshotEvents.fill(0);
+  snapshotTime = frameTime;
+}
+
+void InputTelemetry::press(Input::DeviceType device, size_t button, uint64_t timeNS) {
+  size_t index = Input::controlBit(device, button);
+  auto& stats = controls[index];
+
+  if(stats.presses++ > 0) { stats.pressIntervals[bucket(timeNS - lastPressNS[index])]++; }
+  lastPressNS[index] = timeNS;
+}
+
+void InputTelemetry::release(Input::DeviceType device, size_t button) {
+  size_t index = Input::controlBit(device, button);
+  auto& stats = controls[index];
+
+  //a button that was already down when counting started has no press to measure from
+  if(stats.presses == 0) { return; }
+
+  //gamepad presses are stamped with their sample time, which can be later than the frame time
+  uint64_t heldNS = frameTime > lastPressNS[index] ? frameTime - lastPressNS[index] : 0;
+  stats.holdDurations[bucket(heldNS)]++;
+}
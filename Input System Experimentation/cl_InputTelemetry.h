@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Usage statistics for the merged keyboard, mouse and gamepad (see Input::enableTelemetry()).
+//The counters are fed straight from the button edges and the event queue, and everything is fixed size,
+//so counting never allocates and costs a few increments per edge. Snapshots are taken on demand from the
+//thread that calls Input::update().
+class InputTelemetry {
+public:
+  //Durations are kept in log2 buckets: bucket 0 holds anything under 1ms, bucket n holds [2^(n-1), 2^n) ms,
+  //and the last bucket also holds everything longer (about 16s and up).
+  static constexpr size_t BUCKET_CT = 16;
+  typedef std::array<uint32_t, BUCKET_CT> Histogram;
+  static size_t bucket(uint64_t durationNS);
+
+  struct ControlStats {
+    uint32_t presses;
+    //how long each press was held
+    Histogram holdDurations;
+    //time from one press to the next
+    Histogram pressIntervals;
+  };
+
+  struct DeviceStats {
+    //raw input events for the keyboard and mouse, state changes for the gamepad
+    uint64_t events;
+    //over the time between this snapshot and the previous one
+    double eventsPerSecond;
+  };
+
+  struct Snapshot {
+    //indexed by DeviceType
+    std::array<DeviceStats, 3> devices;
+    //indexed by InputFrame button bit - use control() to look one up
+    std::array<ControlStats, InputFrame::BUTTON_BIT_CT> controls;
+
+    const ControlStats& control(Input::DeviceType device, size_t button) const { return controls[Input::controlBit(device, button)]; }
+  };
+
+  InputTelemetry();
+
+  void snapshot(Snapshot& out);
+  void reset();
+
+  //Input's devices report here while telemetry is enabled. The hold measured by release() runs up to the
+  //current frame's time.
+  void beginFrame(uint64_t frameTimeNS) { frameTime = frameTimeNS; }
+  void countEvent(Input::DeviceType device) { devices[static_cast<size_t>(device)].events++; }
+  void press(Input::DeviceType device, size_t button, uint64_t timeNS);
+  void release(Input::DeviceType device, size_t button);
+
+private:
+  std::array<DeviceStats, 3> devices;
+  std::array<ControlStats, InputFrame::BUTTON_BIT_CT> controls;
+  std::array<uint64_t, InputFrame::BUTTON_BIT_CT> lastPressNS;
+
+  uint64_t frameTime = 0;
+  uint64_t snapshotTime = 0;
+  std::array<uint64_t, 3> snapshotEvents;
+
+};
@@ -0,0 +1,24 @@
+#include "cl_LoopbackTransport.h"
+#include <cstring>
+
+bool LoopbackTransport::send(const uint8_t* data, size_t size) {
+  if(count == CAPACITY || size > MAX_PACKET_SIZE) { return false; }
+
+  Packet& packet = ring[(head + count) % CAPACITY];
+  memcpy(packet.data.data(), data, size);
+  packet.size = size;
+  count++;
+  return true;
+}
+
+size_t LoopbackTransport::receive(uint8_t* out, size_t capacity) {
+  if(count == 0) { return 0; }
+
+  Packet& packet = ring[head];
+  if(packet.size > capacity) { return 0; }
+
+  memcpy(out, packet.data.data(), packet.size);
+  head = (head + 1) % CAPACITY;
+  count--;
+  return packet.size;
+}
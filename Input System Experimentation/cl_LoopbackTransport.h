@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include "cl_InputCodec.h"
+
+//In-memory stand-in for a datagram transport, for exercising the input wire format without a network.
+//Packets are delivered in order from a fixed ring; nothing allocates after construction.
+class LoopbackTransport {
+public:
+  static constexpr size_t CAPACITY = 64;
+  static constexpr size_t MAX_PACKET_SIZE = InputCodec::MAX_ENCODED_SIZE;
+
+  //returns false (and drops the packet) if the ring is full or the packet is too large
+  bool send(const uint8_t* data, size_t size);
+
+  //returns the size of the packet copied into 'out', or 0 if there is nothing to receive or 'capacity' is too small
+  size_t receive(uint8_t* out, size_t capacity);
+
+  size_t pending() const { return count; }
+
+private:
+  struct Packet {
+    std::array<uint8_t, MAX_PACKET_SIZE> data;
+    size_t size;
+  };
+
+  std::array<Packet, CAPACITY> ring;
+  size_t head = 0;
+  size_t count = 0;
+
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Bounded lock-free queue for exactly one producer thread and one consumer thread.
+//'Capacity' must be a power of two. Neither side ever blocks or allocates.
+template<typename T, size_t Capacity>
+class SpscRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  //producer only - returns false if the ring is full
+  bool push(const T& item) {
+    size_t tail = tailIdx.load(std::memory_order_relaxed);
+    if(tail - headIdx.load(std::memory_order_acquire) == Capacity) { return false; }
+
+    items[tail & (Capacity - 1)] = item;
+    tailIdx.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  //consumer only - returns false if the ring is empty
+  bool pop(T& item) {
+    size_t head = headIdx.load(std::memory_order_relaxed);
+    if(head == tailIdx.load(std::memory_order_acquire)) { return false; }
+
+    item = items[head & (Capacity - 1)];
+    headIdx.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //approximate when called while the other side is active
+  size_t size() const { return tailIdx.load(std::memory_order_acquire) - headIdx.load(std::memory_order_acquire); }
+
+private:
+  std::array<T, Capacity> items;
+
+  //Padded onto separate cache lines so the two threads don't fight over them.
+  //Padding is used rather than alignas since over-aligned types aren't supported by new before C++17.
+  static constexpr size_t CACHE_LINE = 64;
+  char padFront[CACHE_LINE];
+  std::atomic<size_t> headIdx{ 0 };
+  char padMiddle[CACHE_LINE - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> tailIdx{ 0 };
+  char padBack[CACHE_LINE - sizeof(std::atomic<size_t>)];
+
+};
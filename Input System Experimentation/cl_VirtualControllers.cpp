@@ -0,0 +1,174 @@
+#include "cl_VirtualControllers.h"
+#include "ns_Utility.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+  //slices are whole multiples of this, so that threads don't share cache lines of the masks
+  constexpr size_t SLICE_ALIGNMENT = 64;
+}
+
+VirtualControllers::VirtualControllers(size_t controllerCt, unsigned int threadCount) :
+  controllerCount(controllerCt),
+  liveHeld(controllerCt), pendingTriggered(controllerCt), pendingReleased(controllerCt), liveAxes(controllerCt * AXIS_CT),
+  held(controllerCt), triggered(controllerCt), released(controllerCt), repeating(controllerCt), axes(controllerCt * AXIS_CT),
+  triggerTimeNS(controllerCt * BUTTON_CT), repeatsFired(controllerCt * BUTTON_CT), repeatCounts(controllerCt * BUTTON_CT)
+{
+  if(threadCount == 0) { throw std::runtime_error("Virtual controllers need at least one thread."); }
+  setRepeat(Input::DEFAULT_REPEAT_DELAY_MS, Input::DEFAULT_REPEAT_PERIOD_MS);
+
+  for(size_t slice = 1; slice < threadCount; slice++) {
+    workers.emplace_back([this, slice]() { workerFn(slice); });
+  }
+}
+
+VirtualControllers::~VirtualControllers() {
+  {
+    std::lock_guard<std::mutex> lock(workMutex);
+    stopping = true;
+  }
+  workReady.notify_all();
+  for(auto& worker : workers) { worker.join(); }
+}
+
+void VirtualControllers::setRepeat(unsigned int delayMS, unsigned int periodMS, ButtonMask repeatButtons) {
+  if(periodMS == 0) { throw std::runtime_error("Repeat period must be nonzero."); }
+  repeatDelayNS = delayMS * Utility::NS_PER_MS;
+  repeatPeriodNS = periodMS * Utility::NS_PER_MS;
+  repeatMask = repeatButtons & ALL_BUTTONS;
+
+  //otherwise a shorter delay or period would fire a burst for buttons that have been held a while
+  for(size_t i = 0; i < controllerCount; i++) {
+    unsigned int bits = held[i];
+    while(bits) {
+      unsigned int b = Utility::lowestSetBit(bits);
+      bits &= bits - 1;
+      triggerTimeNS[i * BUTTON_CT + b] = frameTime;
+      repeatsFired[i * BUTTON_CT + b] = 0;
+    }
+  }
+}
+
+void VirtualControllers::press(size_t controller, size_t button) {
+  ButtonMask bit = static_cast<ButtonMask>(1 << button);
+  if(liveHeld[controller] & bit) { return; }
+  liveHeld[controller] |= bit;
+  pendingTriggered[controller] |= bit;
+}
+
+void VirtualControllers::release(size_t controller, size_t button) {
+  //like Input, a release is reported even if the button wasn't held
+  ButtonMask bit = static_cast<ButtonMask>(1 << button);
+  liveHeld[controller] &= ~bit;
+  pendingReleased[controller] |= bit;
+}
+
+void VirtualControllers::setButtons(size_t controller, ButtonMask heldButtons) {
+  heldButtons &= ALL_BUTTONS;
+  pendingTriggered[controller] |= heldButtons & ~liveHeld[controller];
+  pendingReleased[controller] |= liveHeld[controller] & ~heldButtons;
+  liveHeld[controller] = heldButtons;
+}
+
+void VirtualControllers::update(uint64_t timeNS) {
+  frameTime = timeNS;
+
+  if(workers.empty()) {
+    updateRange(0, controllerCount);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(workMutex);
+    generation++;
+    pendingWorkers = workers.size();
+  }
+  workReady.notify_all();
+
+  updateSlice(0);
+
+  std::unique_lock<std::mutex> lock(workMutex);
+  workDone.wait(lock, [this]() { return pendingWorkers == 0; });
+}
+
+Input::DeviceButton VirtualControllers::button(size_t controller, size_t button) const {
+  ButtonMask bit = static_cast<ButtonMask>(1 << button);
+  Input::DeviceButton btn;
+  btn.held      = (held[controller] & bit) != 0;
+  btn.triggered = (triggered[controller] & bit) != 0;
+  btn.released  = (released[controller] & bit) != 0;
+  btn.repeating = (repeating[controller] & bit) != 0;
+  btn.repeatCount = btn.repeating ? repeatCounts[controller * BUTTON_CT + button] : 0;
+  return btn;
+}
+
+void VirtualControllers::workerFn(size_t slice) {
+  uint64_t seen = 0;
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(workMutex);
+      workReady.wait(lock, [this, seen]() { return stopping || generation != seen; });
+      if(stopping) { return; }
+      seen = generation;
+    }
+
+    updateSlice(slice);
+
+    std::lock_guard<std::mutex> lock(workMutex);
+    if(--pendingWorkers == 0) { workDone.notify_one(); }
+  }
+}
+
+void VirtualControllers::updateSlice(size_t slice) {
+  size_t sliceCt = workers.size() + 1;
+  size_t sliceSize = (controllerCount + sliceCt - 1) / sliceCt;
+  sliceSize = (sliceSize + SLICE_ALIGNMENT - 1) / SLICE_ALIGNMENT * SLICE_ALIGNMENT;
+
+  size_t begin = (std::min)(slice * sliceSize, controllerCount);
+  size_t end = (std::min)(begin + sliceSize, controllerCount);
+  updateRange(begin, end);
+}
+
+void VirtualControllers::updateRange(size_t begin, size_t end) {
+  //publishing is a straight copy of the injected masks and axes
+  for(size_t i = begin; i < end; i++) {
+    held[i] = liveHeld[i];
+    triggered[i] = pendingTriggered[i];
+    released[i] = pendingReleased[i];
+    pendingTriggered[i] = 0;
+    pendingReleased[i] = 0;
+  }
+  for(size_t axis = 0; axis < AXIS_CT; axis++) {
+    size_t first = axis * controllerCount;
+    std::copy(liveAxes.begin() + first + begin, liveAxes.begin() + first + end, axes.begin() + first + begin);
+  }
+
+  //Repeats only visit the buttons that were triggered or are held, so idle controllers cost a few mask
+  //operations. The trigger frame counts as a repeat, as in Input.
+  for(size_t i = begin; i < end; i++) {
+    size_t base = i * BUTTON_CT;
+    ButtonMask repeatingNow = triggered[i];
+
+    unsigned int bits = triggered[i];
+    while(bits) {
+      unsigned int b = Utility::lowestSetBit(bits);
+      bits &= bits - 1;
+      triggerTimeNS[base + b] = frameTime;
+      repeatsFired[base + b] = 0;
+      repeatCounts[base + b] = 1;
+    }
+
+    bits = held[i] & repeatMask & ~triggered[i];
+    while(bits) {
+      unsigned int b = Utility::lowestSetBit(bits);
+      bits &= bits - 1;
+      //every repeat since the last update fires now, so a long tick doesn't swallow any
+      uint64_t repeatCount = Input::repeatsDue(frameTime - triggerTimeNS[base + b], repeatDelayNS, repeatPeriodNS, repeatsFired[base + b]);
+      if(!repeatCount) { continue; }
+      repeatCounts[base + b] = static_cast<uint16_t>((std::min)(repeatCount, uint64_t(0xFFFF)));
+      repeatingNow |= 1 << b;
+    }
+
+    repeating[i] = repeatingNow;
+  }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "cl_Input.h"
+
+//Headless batch of gamepad-like controllers for server-side bots and replay-driven players, with the same
+//trigger, release and repeat semantics as an Input's DeviceButtons but without a window or any devices.
+//Buttons and axes are indexed by Input::Gamepad::Buttons and Input::Gamepad::Axes.
+//State is kept as structure-of-arrays with a fixed footprint per controller, all allocated up front.
+//Events are injected between updates, and update() then publishes every controller's frame in one pass
+//over the arrays - optionally split across worker threads. Reads see the published frame, so injecting
+//the next frame's events doesn't disturb them.
+//Different controllers may be fed from different threads, as long as no controller is fed by two threads
+//at once and nothing is fed during update().
+class VirtualControllers {
+public:
+  static constexpr size_t BUTTON_CT = InputFrame::GAMEPAD_BUTTON_CT;
+  static constexpr size_t AXIS_CT = InputFrame::GAMEPAD_AXIS_CT;
+
+  //one bit per button, in Input::Gamepad::Buttons order
+  typedef uint16_t ButtonMask;
+  static constexpr ButtonMask ALL_BUTTONS = (1 << BUTTON_CT) - 1;
+
+  //'threadCount' includes the thread that calls update() - 1 keeps everything on that thread
+  VirtualControllers(size_t controllerCt, unsigned int threadCount = 1);
+  ~VirtualControllers();
+
+  VirtualControllers(const VirtualControllers&) = delete;
+  void operator=(const VirtualControllers&) = delete;
+
+  size_t size() const { return controllerCount; }
+
+  //The repeat behavior is shared by every controller. Buttons outside 'repeatButtons' never repeat past
+  //their trigger frame, the same as Input::NEVER_REPEAT. Everything repeats on Input's defaults to begin with.
+  //Buttons that are already held start their delay over, as in Input.
+  void setRepeat(unsigned int delayMS, unsigned int periodMS, ButtonMask repeatButtons = ALL_BUTTONS);
+
+  //Injection, applied in order like raw input events. A press while held is ignored, and a press and
+  //release within one frame shows up as both triggered and released.
+  void press(size_t controller, size_t button);
+  void release(size_t controller, size_t button);
+  //presses and releases whatever differs from 'held' - for replays that record whole states
+  void setButtons(size_t controller, ButtonMask held);
+  void setAxis(size_t controller, size_t axis, float value) { liveAxes[axis * controllerCount + controller] = value; }
+
+  //publishes the events injected since the last update for every controller - 'timeNS' is steady_clock
+  //nanoseconds, like Input::frameTimeNS(), and is what repeats are timed against
+  void update(uint64_t timeNS);
+
+  //the published frame
+  Input::DeviceButton button(size_t controller, size_t button) const;
+  ButtonMask heldButtons(size_t controller) const { return held[controller]; }
+  ButtonMask triggeredButtons(size_t controller) const { return triggered[controller]; }
+  ButtonMask releasedButtons(size_t controller) const { return released[controller]; }
+  ButtonMask repeatingButtons(size_t controller) const { return repeating[controller]; }
+  float axis(size_t controller, size_t axis) const { return axes[axis * controllerCount + controller]; }
+
+private:
+  const size_t controllerCount;
+
+  uint64_t repeatDelayNS;
+  uint64_t repeatPeriodNS;
+  ButtonMask repeatMask = ALL_BUTTONS;
+
+  //written by injection
+  std::vector<ButtonMask> liveHeld;
+  std::vector<ButtonMask> pendingTriggered;
+  std::vector<ButtonMask> pendingReleased;
+  //indexed [axis * controllerCount + controller], so each axis is contiguous
+  std::vector<float> liveAxes;
+
+  //written by update()
+  std::vector<ButtonMask> held;
+  std::vector<ButtonMask> triggered;
+  std::vector<ButtonMask> released;
+  std::vector<ButtonMask> repeating;
+  std::vector<float> axes;
+
+  //Indexed [controller * BUTTON_CT + button], only meaningful while the button is held. Repeats are timed
+  //from the trigger like Input's (see Input::repeatsDue()).
+  std::vector<uint64_t> triggerTimeNS;
+  std::vector<uint64_t> repeatsFired;
+  //only meaningful while the button's 'repeating' bit is set
+  std::vector<uint16_t> repeatCounts;
+
+  uint64_t frameTime = 0;
+
+  //Worker threads each take a fixed slice of the controllers. update() bumps 'generation' to start them,
+  //does the first slice itself and then waits for 'pendingWorkers' to reach zero.
+  std::vector<std::thread> workers;
+  std::mutex workMutex;
+  std::condition_variable workReady;
+  std::condition_variable workDone;
+  uint64_t generation = 0;
+  size_t pendingWorkers = 0;
+  bool stopping = false;
+
+  void workerFn(size_t slice);
+  void updateSlice(size_t slice);
+  void updateRange(size_t begin, size_t end);
+
+};
@@ -39,7 +39,7 @@ void Window::clearProcFunc(UINT message) {
 bool Window::update() {
   MSG msg;
   while(PeekMessage(&msg, 0, 0, 0, PM_REMOVE)) {
-    //TranslateMessage(&msg);
+    TranslateMessage(&msg);
     DispatchMessage(&msg);
     if(msg.message == WM_QUIT) { return false; }
   }
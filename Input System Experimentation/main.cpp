@@ -2,8 +2,14 @@
 #include "cl_GfxFactory.h"
 #include "cl_Font.h"
 #include "cl_Input.h"
+#include "cl_InputLoadGenerator.h"
+#include "cl_FramePacer.h"
+#include "cl_InputExporter.h"
+#include "cl_InputBroadcast.h"
 #include <sstream>
 #include <string>
+#include <cstring>
+#include <memory>
 
 void appendButton(std::wstringstream& stream, const Input::DeviceButton& button) {
   stream <<  "[";
@@ -52,22 +58,75 @@ std::wstring g_to_s(const Input::DeviceState& state) {
   return ss.str();
 }
 
-int CALLBACK WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
+std::wstring soak_to_s(const InputLoadGenerator::Report& report) {
+  std::wstringstream ss;
+
+  ss << "Frames: " << report.frames << "\n";
+  ss << "Events: " << report.eventsInjected << " (" << static_cast<uint64_t>(report.eventsPerSecond) << "/s)\n";
+  ss << "Queue high-water: " << report.queueHighWater << "\n";
+  ss << "Divergences: " << report.divergences << "\n";
+  if(report.divergences) { ss << report.firstDivergence.c_str() << "\n"; }
+
+  return ss.str();
+}
+
+std::wstring pacer_to_s(const FramePacer::Stats& stats) {
+  std::wstringstream ss;
+
+  ss.precision(1);
+  ss << std::fixed;
+  ss << "Frame: " << stats.meanPeriodUS << "us (jitter " << stats.jitterUS << "us, max " << stats.maxPeriodUS << "us, missed " << stats.missedDeadlines << ")\n";
+  ss << "Work estimate: " << stats.workEstimateUS << "us, input age: " << stats.meanInputAgeUS << "us\n";
+
+  return ss.str();
+}
+
+//floods the input system with synthetic events until the window is closed (launch with --soak)
+int runSoak(Window& win, Graphics& gfx, Font& font, Input& input) {
+  InputLoadGenerator generator(input, InputLoadGenerator::Config());
+
+  while(win.update()) {
+    gfx.clear();
+    generator.runFrame();
+    font.drawText(soak_to_s(generator.report()), 10, 5, 5, generator.report().divergences ? ColorF::RED : ColorF::GREEN);
+    gfx.present();
+  }
+
+  return generator.report().divergences ? 1 : 0;
+}
+
+int CALLBACK WinMain(HINSTANCE, HINSTANCE, LPSTR cmdLine, int) {
   Window win("Input System", { 800, 600 });
   Graphics gfx(win);
   GfxFactory factory = gfx.createFactory();
   Font font = factory.createFont(L"Courier New");
   Input input(win);
 
-  while(win.update()) {
-    Sleep(50);
+  if(strstr(cmdLine, "--soak")) { return runSoak(win, gfx, font, input); }
+
+  //streams the input state to an external viewer (see InputExporter)
+  std::unique_ptr<InputExporter> exporter;
+  if(strstr(cmdLine, "--export")) { exporter.reset(new InputExporter(input)); }
+
+  //publishes the input state to companion processes (see InputBroadcast)
+  std::unique_ptr<InputBroadcast> broadcast;
+  if(strstr(cmdLine, "--broadcast")) { broadcast.reset(new InputBroadcast(input)); }
+
+  //the messages are pumped after the pacer's wait so that input.update() sees everything up to that point
+  constexpr unsigned int FRAME_PERIOD_US = 16667;
+  FramePacer pacer(FRAME_PERIOD_US);
+  for(;;) {
+    pacer.beginFrame();
+    if(!win.update()) { break; }
 
     gfx.clear();
     input.update();
     font.drawText(k_to_s(input.keyboard()), 10, 5, 5, ColorF::CYAN);
     font.drawText(m_to_s(input.mouse()), 10, 5, 200, ColorF::MAGENTA);
     font.drawText(g_to_s(input.gamepad()), 10, 5, 235, ColorF::YELLOW);
+    font.drawText(pacer_to_s(pacer.stats()), 10, 5, 520, ColorF::WHITE);
     gfx.present();
+    pacer.endFrame();
   }
 
   return 0;
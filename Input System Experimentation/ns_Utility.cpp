@@ -1,5 +1,7 @@
 #include "ns_Utility.h"
 #include <fstream>
+#include <chrono>
+#include <intrin.h>
 
 Utility::OnScopeExit::OnScopeExit(std::function<void()> func) {
   reset(func);
@@ -17,6 +19,27 @@ void Utility::OnScopeExit::release() {
   reset([]() {});
 }
 
+unsigned int Utility::lowestSetBit(uint64_t bits) {
+  //_BitScanForward64 is x64-only, so scan the halves separately to keep the Win32 build working
+  unsigned long index;
+  if(_BitScanForward(&index, static_cast<unsigned long>(bits))) { return index; }
+  _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+  return index + 32;
+}
+
+unsigned int Utility::highestSetBit(uint64_t bits) {
+  unsigned long index;
+  if(_BitScanReverse(&index, static_cast<unsigned long>(bits >> 32))) { return index + 32; }
+  _BitScanReverse(&index, static_cast<unsigned long>(bits));
+  return index;
+}
+
+uint64_t Utility::nowNS() {
+  //steady_clock is guaranteed monotonic, so elapsed times can never go negative
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
 std::vector<char> Utility::readFile(const std::string& filename) {
   std::ifstream file(filename, std::ifstream::binary);
   assert(file);
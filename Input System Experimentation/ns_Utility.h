@@ -2,6 +2,8 @@
 #include <functional>
 #include <vector>
 #include <cassert>
+#include <cstdint>
+#include <string>
 
 #define HR(a) { HRESULT hr = a; assert(SUCCEEDED(hr)); }
 
@@ -29,6 +31,22 @@ namespace Utility {
 
   };
 
+  ///<summary>Find the index of the lowest set bit</summary>
+  ///<param name="bits">The value to scan - must not be zero</param>
+  unsigned int lowestSetBit(uint64_t bits);
+
+  ///<summary>Find the index of the highest set bit</summary>
+  ///<param name="bits">The value to scan - must not be zero</param>
+  unsigned int highestSetBit(uint64_t bits);
+
+  ///<summary>Conversions for nanosecond times</summary>
+  constexpr uint64_t NS_PER_US     = 1000;
+  constexpr uint64_t NS_PER_MS     = 1000000;
+  constexpr uint64_t NS_PER_SECOND = 1000000000;
+
+  ///<summary>The current steady_clock time in nanoseconds, the clock that Input::update() and its timestamps use</summary>
+  uint64_t nowNS();
+
   ///<summary>Read a file into a vector of char (binary read)</summary>
   ///<param name="filename">Path to the file to be read</param>
   std::vector<char> readFile(const std::string& filename);
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+//Compact snapshot of the merged input state for a single frame.
+//Only 'held' is stored for buttons - the triggered/released edges fall out of comparing consecutive
+//frames. Axes are quantized to int16 so that snapshots compare, hash and serialize exactly.
+struct InputFrame {
+  //bit layout of 'buttons'
+  static constexpr size_t KEYBOARD_BUTTON_OFFSET = 0;
+  static constexpr size_t KEYBOARD_BUTTON_CT     = 255;
+  static constexpr size_t MOUSE_BUTTON_OFFSET    = 256;
+  static constexpr size_t MOUSE_BUTTON_CT        = 5;
+  static constexpr size_t GAMEPAD_BUTTON_OFFSET  = 264;
+  static constexpr size_t GAMEPAD_BUTTON_CT      = 14;
+  static constexpr size_t BUTTON_WORD_CT         = 5;
+  static constexpr size_t BUTTON_BIT_CT          = BUTTON_WORD_CT * 64;
+
+  //layout of 'axes'
+  static constexpr size_t MOUSE_AXIS_OFFSET   = 0;
+  static constexpr size_t MOUSE_AXIS_CT       = 3;
+  static constexpr size_t GAMEPAD_AXIS_OFFSET = 3;
+  static constexpr size_t GAMEPAD_AXIS_CT     = 6;
+  static constexpr size_t AXIS_CT             = 9;
+
+  uint32_t frameNumber = 0;
+  std::array<uint64_t, BUTTON_WORD_CT> buttons = {};
+  std::array<int16_t, AXIS_CT> axes = {};
+
+  bool held(size_t bit) const { return (buttons[bit / 64] >> (bit % 64)) & 1; }
+
+  void setHeld(size_t bit, bool isHeld) {
+    uint64_t mask = uint64_t(1) << (bit % 64);
+    if(isHeld) { buttons[bit / 64] |= mask; }
+    else       { buttons[bit / 64] &= ~mask; }
+  }
+
+  //gamepad axes are in [-1, 1]
+  //(min/max are parenthesized to dodge the Windows.h macros)
+  static int16_t quantizeUnit(float value) {
+    float clamped = (std::min)((std::max)(value, -1.0f), 1.0f);
+    return static_cast<int16_t>(std::lround(clamped * 32767));
+  }
+  static float dequantizeUnit(int16_t value) { return value / 32767.0f; }
+
+  //mouse axes are whole counts, so they only need clamping
+  static int16_t quantizeCount(float value) {
+    float clamped = (std::min)((std::max)(value, -32768.0f), 32767.0f);
+    return static_cast<int16_t>(std::lround(clamped));
+  }
+
+  //compares the input only - the frame numbers are ignored
+  bool sameInput(const InputFrame& other) const { return buttons == other.buttons && axes == other.axes; }
+
+};
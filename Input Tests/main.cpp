@@ -0,0 +1,28 @@
+#include "ns_Test.h"
+#include <iostream>
+#include <cstring>
+
+//Runs every registered test case, or only those whose names contain one of the arguments.
+//usage: "Input Tests" [name filter]...
+int main(int argc, char** argv) {
+  size_t run = 0;
+  size_t failed = 0;
+
+  for(auto& test : Test::cases()) {
+    bool selected = argc < 2;
+    for(int i = 1; i < argc; i++) { selected |= strstr(test.name, argv[i]) != nullptr; }
+    if(!selected) { continue; }
+
+    run++;
+    try {
+      test.run();
+    }
+    catch(const std::exception& e) {
+      failed++;
+      std::cerr << test.name << ": " << e.what() << "\n";
+    }
+  }
+
+  std::cout << run - failed << "/" << run << " passed\n";
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#include "ns_Test.h"
+#include <string>
+#include <sstream>
+
+namespace {
+  void keyEvent(Input& input, unsigned short vk, UINT message, HANDLE device) {
+    RAWINPUT event = {};
+    event.header.dwType = RIM_TYPEKEYBOARD;
+    event.header.hDevice = device;
+    event.data.keyboard.VKey = vk;
+    event.data.keyboard.Message = message;
+    input.injectEvent(event);
+  }
+}
+
+std::vector<Test::Case>& Test::cases() {
+  //TEST_CASE registrars in the test_*.cpp files run during their own static initialization, which may come
+  //before this file's, so the list is built on first use instead
+  static std::vector<Case> registered;
+  return registered;
+}
+
+void Test::fail(const char* file, int line, const char* expression) {
+  throw Failure(std::string(file) + "(" + std::to_string(line) + "): CHECK(" + expression + ") failed");
+}
+
+void Test::pressKey(Input& input, unsigned short vk, HANDLE device) {
+  keyEvent(input, vk, WM_KEYDOWN, device);
+}
+
+void Test::releaseKey(Input& input, unsigned short vk, HANDLE device) {
+  keyEvent(input, vk, WM_KEYUP, device);
+}
+
+void Test::step(Input& input, uint64_t& timeNS, unsigned int ms) {
+  timeNS += ms * uint64_t(1000000);
+  input.update(timeNS);
+}
+
+void Test::stepFrames(Input& input, uint64_t& timeNS, unsigned int count) {
+  for(unsigned int i = 0; i < count; i++) { step(input, timeNS); }
+}
+
+std::unique_ptr<InputConfig> Test::parseConfig(const char* text, std::string* error) {
+  std::istringstream stream(text);
+  std::string parseError;
+  auto config = InputConfig::parse(stream, parseError);
+  if(error) { *error = parseError; }
+  return config;
+}
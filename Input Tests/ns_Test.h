@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include "cl_Input.h"
+#include "cl_InputConfig.h"
+
+//Minimal test registry for the Input Tests runner (see main.cpp). A TEST_CASE registers itself before
+//main() runs, and a failed CHECK throws a Failure naming the file, line and expression, which the runner
+//reports before moving on to the next case.
+namespace Test {
+  struct Failure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  struct Case {
+    const char* name;
+    void (*run)();
+  };
+  std::vector<Case>& cases();
+
+  struct Registrar {
+    Registrar(const char* name, void (*run)()) { cases().push_back(Case{ name, run }); }
+  };
+
+  [[noreturn]] void fail(const char* file, int line, const char* expression);
+
+  //Time starts here rather than at zero, which Input treats as never having updated, and most tests
+  //advance it a frame of FRAME_MS at a time.
+  constexpr uint64_t START_TIME_NS = 1000000000;
+  constexpr unsigned int FRAME_MS = 10;
+
+  //Headless input helpers. Keyboard events come from a fake raw input device, KEYBOARD unless another is given.
+  const HANDLE KEYBOARD = reinterpret_cast<HANDLE>(0x7E570001);
+  void pressKey(Input& input, unsigned short vk, HANDLE device = KEYBOARD);
+  void releaseKey(Input& input, unsigned short vk, HANDLE device = KEYBOARD);
+  //advances 'timeNS' by 'ms' and updates as of the new time
+  void step(Input& input, uint64_t& timeNS, unsigned int ms = FRAME_MS);
+  //'count' steps of FRAME_MS
+  void stepFrames(Input& input, uint64_t& timeNS, unsigned int count);
+
+  //parses 'text' as a configuration file - returns null and fills in 'error' (if given) if it's invalid
+  std::unique_ptr<InputConfig> parseConfig(const char* text, std::string* error = nullptr);
+}
+
+#define TEST_CASE(name) \
+  static void name(); \
+  static Test::Registrar name##Registrar(#name, name); \
+  static void name()
+
+#define CHECK(expression) do { if(!(expression)) { Test::fail(__FILE__, __LINE__, #expression); } } while(0)
+
+//passes if 'statement' throws a std::exception
+#define CHECK_THROWS(statement) do { \
+    bool threw = false; \
+    try { statement; } catch(const std::exception&) { threw = true; } \
+    if(!threw) { Test::fail(__FILE__, __LINE__, #statement " throws"); } \
+  } while(0)
@@ -0,0 +1,50 @@
+#include "ns_Test.h"
+#include "cl_InputBuffer.h"
+#include "ns_Utility.h"
+
+namespace {
+  constexpr size_t CONTROL = 'A';
+}
+
+TEST_CASE(bufferCountsPressesInTheWindow) {
+  InputBuffer buffer;
+  uint64_t timeNS = Test::START_TIME_NS;
+  buffer.beginFrame(timeNS);
+  CHECK(buffer.pressesWithin(CONTROL, Utility::NS_PER_SECOND) == 0);
+  CHECK(!buffer.releasedWithin(CONTROL, Utility::NS_PER_SECOND));
+
+  //more presses than the ring holds, 10ms apart
+  for(int i = 0; i < 6; i++) {
+    timeNS += 10 * Utility::NS_PER_MS;
+    buffer.beginFrame(timeNS);
+    buffer.press(CONTROL, timeNS);
+    buffer.release(CONTROL);
+  }
+  CHECK(buffer.pressesWithin(CONTROL, Utility::NS_PER_SECOND) == InputBuffer::DEPTH);
+  CHECK(buffer.pressesWithin(CONTROL, 15 * Utility::NS_PER_MS) == 2);
+  CHECK(buffer.releasedWithin(CONTROL, 0));
+
+  CHECK(buffer.pressedWithin(CONTROL, 0));
+  CHECK(buffer.consumePress(CONTROL));
+  CHECK(!buffer.pressedWithin(CONTROL, Utility::NS_PER_SECOND) && !buffer.consumePress(CONTROL));
+  //consumed presses still count towards multi-taps
+  CHECK(buffer.pressesWithin(CONTROL, 15 * Utility::NS_PER_MS) == 2);
+
+  buffer.reset();
+  CHECK(buffer.pressesWithin(CONTROL, Utility::NS_PER_SECOND) == 0);
+  CHECK(!buffer.releasedWithin(CONTROL, Utility::NS_PER_SECOND));
+}
+
+TEST_CASE(bufferWindowsEndAtTheFrame) {
+  InputBuffer buffer;
+  uint64_t timeNS = Test::START_TIME_NS;
+  buffer.beginFrame(timeNS);
+  buffer.press(CONTROL, timeNS);
+
+  timeNS += 100 * Utility::NS_PER_MS;
+  buffer.beginFrame(timeNS);
+  CHECK(buffer.pressedWithin(CONTROL, 100 * Utility::NS_PER_MS));
+  CHECK(!buffer.pressedWithin(CONTROL, 99 * Utility::NS_PER_MS));
+  CHECK(buffer.pressesWithin(CONTROL, 99 * Utility::NS_PER_MS) == 0);
+  CHECK(!buffer.releasedWithin(CONTROL, Utility::NS_PER_SECOND));
+}
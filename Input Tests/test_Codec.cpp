@@ -0,0 +1,87 @@
+#include "ns_Test.h"
+#include "cl_InputCodec.h"
+#include "cl_LoopbackTransport.h"
+#include <random>
+
+namespace {
+  //a random walk, so that consecutive frames share most of their state the way real input does
+  void mutate(InputFrame& frame, std::mt19937& rng) {
+    unsigned int changes = rng() % 4;
+    for(unsigned int i = 0; i < changes; i++) {
+      size_t bit = rng() % InputFrame::BUTTON_BIT_CT;
+      frame.setHeld(bit, !frame.held(bit));
+    }
+    if(rng() % 3 == 0) { frame.axes[rng() % InputFrame::AXIS_CT] = static_cast<int16_t>(rng()); }
+  }
+}
+
+TEST_CASE(codecRoundTripsRandomSequencesOverLoopback) {
+  std::mt19937 rng(31);
+  LoopbackTransport transport;
+  uint8_t packet[InputCodec::MAX_ENCODED_SIZE];
+
+  InputFrame sent;
+  InputFrame sentBaseline;
+  InputFrame received;
+  InputFrame receivedBaseline;
+  bool haveBaseline = false;
+  sent.frameNumber = 0xFFFFFF00;
+
+  for(int i = 0; i < 20000; i++) {
+    //frames are skipped now and then, and the numbers wrap around partway through
+    sent.frameNumber += 1 + (rng() % 8 == 0 ? rng() % 300 : 0);
+    mutate(sent, rng);
+
+    size_t size = InputCodec::encode(sent, haveBaseline ? &sentBaseline : nullptr, packet, sizeof(packet));
+    CHECK(size > 0);
+    CHECK(transport.send(packet, size));
+
+    size = transport.receive(packet, sizeof(packet));
+    CHECK(size > 0);
+    CHECK(InputCodec::decode(packet, size, haveBaseline ? &receivedBaseline : nullptr, received));
+    CHECK(received.frameNumber == sent.frameNumber && received.sameInput(sent));
+
+    //every so often the baseline isn't acknowledged, so the next frame is encoded against an older one
+    if(!haveBaseline || rng() % 4 != 0) {
+      sentBaseline = sent;
+      receivedBaseline = received;
+      haveBaseline = true;
+    }
+  }
+}
+
+TEST_CASE(codecIdleDeltaFramesAreTwoBytes) {
+  InputFrame baseline;
+  baseline.frameNumber = 123456;
+  baseline.setHeld(InputFrame::KEYBOARD_BUTTON_OFFSET + 'W', true);
+  baseline.axes[InputFrame::GAMEPAD_AXIS_OFFSET] = 9000;
+
+  InputFrame frame = baseline;
+  frame.frameNumber++;
+  uint8_t packet[InputCodec::MAX_ENCODED_SIZE];
+  CHECK(InputCodec::encode(frame, &baseline, packet, sizeof(packet)) == 2);
+
+  frame.setHeld(InputFrame::MOUSE_BUTTON_OFFSET, true);
+  CHECK(InputCodec::encode(frame, &baseline, packet, sizeof(packet)) <= 5);
+}
+
+TEST_CASE(codecRejectsTheWrongBaseline) {
+  InputFrame baseline;
+  baseline.frameNumber = 50;
+  InputFrame frame = baseline;
+  frame.frameNumber = 51;
+  frame.setHeld(3, true);
+
+  uint8_t packet[InputCodec::MAX_ENCODED_SIZE];
+  size_t size = InputCodec::encode(frame, &baseline, packet, sizeof(packet));
+  InputFrame decoded;
+  CHECK(!InputCodec::decode(packet, size, nullptr, decoded));
+
+  //a different frame number or different contents both change the check byte
+  InputFrame other = baseline;
+  other.frameNumber = 49;
+  CHECK(!InputCodec::decode(packet, size, &other, decoded));
+  other = baseline;
+  other.setHeld(200, true);
+  CHECK(!InputCodec::decode(packet, size, &other, decoded));
+}
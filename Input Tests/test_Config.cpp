@@ -0,0 +1,121 @@
+#include "ns_Test.h"
+
+namespace {
+  //true if 'text' is rejected with an error containing 'message'
+  bool rejects(const char* text, const char* message) {
+    std::string error;
+    return !Test::parseConfig(text, &error) && error.find(message) != std::string::npos;
+  }
+
+  bool isBound(const InputConfig& config, const char* action, size_t control) {
+    size_t count;
+    const uint16_t* controls = config.bindings(InputConfig::actionID(action), count);
+    for(size_t i = 0; i < count; i++) {
+      if(controls[i] == control) { return true; }
+    }
+    return false;
+  }
+}
+
+TEST_CASE(emptyConfigHasInputDefaults) {
+  std::string error;
+  auto config = Test::parseConfig("# nothing but a comment\n\n", &error);
+  CHECK(config && error.empty());
+  CHECK(config->deadZones()[Input::Gamepad::LEFT_X] == Input::DEFAULT_DEAD_ZONE);
+  CHECK(config->repeatProfiles().size() == 2);
+  CHECK(config->repeatProfiles()[Input::DEFAULT_REPEAT].delayMS == Input::DEFAULT_REPEAT_DELAY_MS);
+  CHECK(config->repeatProfiles()[Input::DEFAULT_REPEAT].periodMS == Input::DEFAULT_REPEAT_PERIOD_MS);
+  for(uint8_t profile : config->buttonProfiles()) { CHECK(profile == Input::DEFAULT_REPEAT); }
+}
+
+TEST_CASE(directivesFillTheConfig) {
+  std::string error;
+  auto config = Test::parseConfig(
+    "deadzone RTRIGGER 0.25\n"
+    "repeat 300 50   # the default profile\n"
+    "profile menu 200 40\n"
+    "repeatwith menu key:UP key:DOWN pad:DPAD_UP\n"
+    "repeatwith never mouse:L_BUTTON\n"
+    "bind jump key:SPACE pad:A\n"
+    "bind jump key:SPACE\n", &error);
+  CHECK(config && error.empty());
+
+  CHECK(config->deadZones()[Input::Gamepad::RTRIGGER] == 0.25f);
+  CHECK(config->deadZones()[Input::Gamepad::LEFT_X] == Input::DEFAULT_DEAD_ZONE);
+
+  auto& profiles = config->repeatProfiles();
+  CHECK(profiles.size() == 3);
+  CHECK(profiles[Input::DEFAULT_REPEAT].delayMS == 300 && profiles[Input::DEFAULT_REPEAT].periodMS == 50);
+  CHECK(profiles[2].delayMS == 200 && profiles[2].periodMS == 40);
+
+  auto& buttons = config->buttonProfiles();
+  CHECK(buttons[Input::controlBit(Input::DeviceType::KEYBOARD, VK_UP)] == 2);
+  CHECK(buttons[Input::controlBit(Input::DeviceType::KEYBOARD, VK_DOWN)] == 2);
+  CHECK(buttons[Input::controlBit(Input::DeviceType::GAMEPAD, Input::Gamepad::DPAD_UP)] == 2);
+  CHECK(buttons[Input::controlBit(Input::DeviceType::MOUSE, Input::Mouse::L_BUTTON)] == Input::NEVER_REPEAT);
+  CHECK(buttons[Input::controlBit(Input::DeviceType::KEYBOARD, VK_LEFT)] == Input::DEFAULT_REPEAT);
+
+  //a control bound twice is only listed once
+  size_t count;
+  config->bindings(InputConfig::actionID("jump"), count);
+  CHECK(count == 2);
+  CHECK(isBound(*config, "jump", Input::controlBit(Input::DeviceType::KEYBOARD, VK_SPACE)));
+  CHECK(isBound(*config, "jump", Input::controlBit(Input::DeviceType::GAMEPAD, Input::Gamepad::A)));
+}
+
+TEST_CASE(keysCanBeWrittenSeveralWays) {
+  std::string error;
+  auto config = Test::parseConfig("bind keys key:0x41 key:7 key:F1 key:F24 key:ESCAPE key:PAGEDOWN\n", &error);
+  CHECK(config);
+  const unsigned short keys[] = { 'A', '7', VK_F1, VK_F24, VK_ESCAPE, VK_NEXT };
+  for(unsigned short vk : keys) {
+    CHECK(isBound(*config, "keys", Input::controlBit(Input::DeviceType::KEYBOARD, vk)));
+  }
+
+  CHECK(rejects("bind a key:F0\n", "unknown control 'key:F0'"));
+  CHECK(rejects("bind a key:F25\n", "unknown control"));
+  CHECK(rejects("bind a key:0x0\n", "unknown control"));
+  CHECK(rejects("bind a key:0x100\n", "unknown control"));
+  CHECK(rejects("bind a key:a\n", "unknown control"));
+  CHECK(rejects("bind a pad:L_BUTTON\n", "unknown control"));
+  CHECK(rejects("bind a SPACE\n", "unknown control"));
+}
+
+TEST_CASE(invalidConfigsAreRejected) {
+  CHECK(rejects("profile menu 200 40\nprofile menu 100 20\n", "line 2: profile 'menu' is already declared"));
+  CHECK(rejects("profile default 200 40\n", "already declared"));
+  CHECK(rejects("repeatwith menu key:A\n", "unknown profile 'menu'"));
+  CHECK(rejects("\nbind jump key:NOPE\n", "line 2: unknown control 'key:NOPE'"));
+  CHECK(rejects("repeat 200 0\n", "repeat period must be nonzero"));
+  CHECK(rejects("profile menu 200 0\n", "repeat period must be nonzero"));
+  CHECK(rejects("repeat -1 10\n", "invalid repeat time"));
+  CHECK(rejects("deadzone LEFT_X 1\n", "dead zone radius"));
+  CHECK(rejects("deadzone LEFT_X -0.1\n", "dead zone radius"));
+  CHECK(rejects("deadzone LEFT_Z 0.2\n", "unknown axis 'LEFT_Z'"));
+  CHECK(rejects("bind jump\n", "expected 'bind <action> <control>...'"));
+  CHECK(rejects("rebind jump key:A\n", "unknown directive 'rebind'"));
+}
+
+TEST_CASE(collidingActionIDsAreRejected) {
+  //a known FNV-1a collision
+  static_assert(InputConfig::actionID("costarring") == InputConfig::actionID("liquid"), "not a collision");
+  CHECK(rejects("bind costarring key:A\nbind liquid key:B\n", "actions 'costarring' 'liquid' have the same ID"));
+
+  std::string error;
+  CHECK(Test::parseConfig("bind costarring key:A\nbind costarring key:B\n", &error));
+}
+
+TEST_CASE(bindingsLookUpEveryAction) {
+  std::string error;
+  auto config = Test::parseConfig("bind jump key:SPACE\nbind fire mouse:L_BUTTON pad:RSHOULDER\nbind crouch key:C\n", &error);
+  CHECK(config);
+
+  size_t count;
+  CHECK(config->bindings(InputConfig::actionID("fire"), count) && count == 2);
+  CHECK(isBound(*config, "fire", Input::controlBit(Input::DeviceType::MOUSE, Input::Mouse::L_BUTTON)));
+  CHECK(isBound(*config, "fire", Input::controlBit(Input::DeviceType::GAMEPAD, Input::Gamepad::RSHOULDER)));
+  CHECK(isBound(*config, "crouch", Input::controlBit(Input::DeviceType::KEYBOARD, 'C')));
+  CHECK(!isBound(*config, "crouch", Input::controlBit(Input::DeviceType::KEYBOARD, VK_SPACE)));
+
+  CHECK(!config->bindings(InputConfig::actionID("walk"), count) && count == 0);
+}
@@ -0,0 +1,131 @@
+#include "ns_Test.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+  const HANDLE SECOND_KEYBOARD = reinterpret_cast<HANDLE>(0x7E570002);
+  const HANDLE TEST_MOUSE = reinterpret_cast<HANDLE>(0x7E570003);
+
+  //Devices the test plugs in and pulls out. The watcher queries it from its worker thread.
+  class FakeDevices : public DeviceWatcher::Source {
+  public:
+    std::atomic<bool> padConnected{ false };
+
+    void add(HANDLE device, DeviceWatcher::DeviceDesc::Kind kind) {
+      std::lock_guard<std::mutex> lock(mtx);
+      kinds[device] = kind;
+    }
+
+    bool describe(HANDLE device, DeviceWatcher::DeviceDesc& desc) override {
+      std::lock_guard<std::mutex> lock(mtx);
+      auto iter = kinds.find(device);
+      if(iter == kinds.end()) { return false; }
+      desc.kind = iter->second;
+      return true;
+    }
+
+    bool xinputConnected(DWORD slot) override { return slot == 0 && padConnected; }
+
+  private:
+    std::mutex mtx;
+    std::map<HANDLE, DeviceWatcher::DeviceDesc::Kind> kinds;
+  };
+
+  //Gives 'input' a watcher over 'devices' that polls XInput every millisecond. The watcher belongs to
+  //'input', and the returned pointer stands in for the window proc's notifications.
+  DeviceWatcher* watchFakeDevices(Input& input, FakeDevices*& devices) {
+    devices = new FakeDevices();
+    DeviceWatcher* watcher = new DeviceWatcher(std::unique_ptr<DeviceWatcher::Source>(devices), std::chrono::milliseconds(1));
+    input.watchDevices(std::unique_ptr<DeviceWatcher>(watcher));
+    return watcher;
+  }
+
+  //The watcher's worker finishes changes in its own time, so this updates until 'done' is true or a couple
+  //of seconds have passed.
+  template<typename Predicate>
+  bool updateUntil(Input& input, uint64_t& timeNS, Predicate done) {
+    for(int i = 0; i < 400; i++) {
+      Test::step(input, timeNS);
+      if(done()) { return true; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+  }
+
+  bool hasDevice(const std::vector<Input::DeviceID>& ids, HANDLE device) {
+    return std::find(ids.begin(), ids.end(), device) != ids.end();
+  }
+}
+
+TEST_CASE(arrivalCreatesAPhysicalSlot) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  FakeDevices* devices;
+  DeviceWatcher* watcher = watchFakeDevices(input, devices);
+
+  devices->add(SECOND_KEYBOARD, DeviceWatcher::DeviceDesc::RAW_KEYBOARD);
+  devices->add(TEST_MOUSE, DeviceWatcher::DeviceDesc::RAW_MOUSE);
+  watcher->notifyArrival(SECOND_KEYBOARD);
+  watcher->notifyArrival(TEST_MOUSE);
+  CHECK(updateUntil(input, timeNS, [&input]() { return input.connectedDevices().size() == 2; }));
+
+  CHECK(hasDevice(input.physicalDevices(Input::DeviceType::KEYBOARD), SECOND_KEYBOARD));
+  CHECK(hasDevice(input.physicalDevices(Input::DeviceType::MOUSE), TEST_MOUSE));
+  CHECK(!input.physicalDevice(SECOND_KEYBOARD).buttons['A'].held);
+
+  //the OS reports devices it already told us about again on registration, which mustn't add a second slot
+  watcher->notifyArrival(SECOND_KEYBOARD);
+  Test::stepFrames(input, timeNS, 10);
+  CHECK(input.physicalDevices(Input::DeviceType::KEYBOARD).size() == 1);
+  CHECK(input.connectedDevices().size() == 2);
+}
+
+TEST_CASE(removalRetiresTheSlotAndReleasesHeldButtons) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  FakeDevices* devices;
+  DeviceWatcher* watcher = watchFakeDevices(input, devices);
+
+  devices->add(Test::KEYBOARD, DeviceWatcher::DeviceDesc::RAW_KEYBOARD);
+  devices->add(SECOND_KEYBOARD, DeviceWatcher::DeviceDesc::RAW_KEYBOARD);
+  watcher->notifyArrival(Test::KEYBOARD);
+  watcher->notifyArrival(SECOND_KEYBOARD);
+  CHECK(updateUntil(input, timeNS, [&input]() { return input.connectedDevices().size() == 2; }));
+
+  Test::pressKey(input, 'A');
+  Test::pressKey(input, 'B', SECOND_KEYBOARD);
+  Test::step(input, timeNS);
+  CHECK(input.keyboard().buttons['A'].held && input.keyboard().buttons['B'].held);
+
+  watcher->notifyRemoval(Test::KEYBOARD);
+  CHECK(updateUntil(input, timeNS, [&input]() { return !input.deviceChanges().empty(); }));
+  CHECK(!input.deviceChanges()[0].arrived && input.deviceChanges()[0].desc.handle == Test::KEYBOARD);
+
+  //only the removed keyboard's buttons go up
+  CHECK(input.keyboard().buttons['A'].released && !input.keyboard().buttons['A'].held);
+  CHECK(input.keyboard().buttons['B'].held);
+  CHECK(!hasDevice(input.physicalDevices(Input::DeviceType::KEYBOARD), Test::KEYBOARD));
+  CHECK(hasDevice(input.physicalDevices(Input::DeviceType::KEYBOARD), SECOND_KEYBOARD));
+  CHECK(input.connectedDevices().size() == 1);
+}
+
+TEST_CASE(xinputPollTogglesConnected) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  FakeDevices* devices;
+  watchFakeDevices(input, devices);
+
+  Test::step(input, timeNS);
+  CHECK(!input.gamepadConnected());
+
+  devices->padConnected = true;
+  CHECK(updateUntil(input, timeNS, [&input]() { return input.gamepadConnected(); }));
+  CHECK(input.connectedDevices().size() == 1 && input.connectedDevices()[0].kind == DeviceWatcher::DeviceDesc::XINPUT);
+
+  devices->padConnected = false;
+  CHECK(updateUntil(input, timeNS, [&input]() { return !input.gamepadConnected(); }));
+  CHECK(input.connectedDevices().empty());
+}
@@ -0,0 +1,51 @@
+#include "ns_Test.h"
+#include "cl_InputDigest.h"
+
+TEST_CASE(digestChainCatchesAnIntraFrameTap) {
+  Input steady;
+  Input tapping;
+  InputDigest& steadyDigest = steady.enableDigest();
+  InputDigest& tappingDigest = tapping.enableDigest();
+  uint64_t steadyTime = Test::START_TIME_NS;
+  uint64_t tappingTime = Test::START_TIME_NS;
+
+  Test::pressKey(steady, 'W');
+  Test::pressKey(tapping, 'W');
+  Test::step(steady, steadyTime);
+  Test::step(tapping, tappingTime);
+  CHECK(steadyDigest.current().chain == tappingDigest.current().chain);
+
+  //Q goes down and up again before the update, so the held state ends up the same on both peers
+  Test::pressKey(tapping, 'Q');
+  Test::releaseKey(tapping, 'Q');
+  Test::step(steady, steadyTime);
+  Test::step(tapping, tappingTime);
+  CHECK(tapping.keyboard().buttons['Q'].triggered && !tapping.keyboard().buttons['Q'].held);
+  CHECK(steadyDigest.current().state == tappingDigest.current().state);
+  CHECK(steadyDigest.current().edges != tappingDigest.current().edges);
+  CHECK(steadyDigest.current().chain != tappingDigest.current().chain);
+}
+
+TEST_CASE(digestEdgesMatchTheFrameWords) {
+  Input input;
+  InputDigest& digest = input.enableDigest();
+  uint64_t timeNS = Test::START_TIME_NS;
+
+  Test::pressKey(input, 'A');
+  Test::pressKey(input, 'B');
+  Test::releaseKey(input, 'B');
+  Test::step(input, timeNS);
+
+  std::array<uint64_t, InputFrame::BUTTON_WORD_CT> released = {};
+  size_t b = Input::controlBit(Input::DeviceType::KEYBOARD, 'B');
+  released[b / 64] |= uint64_t(1) << (b % 64);
+  CHECK(digest.current().edges == InputDigest::edgesOf(input.triggeredWords(), released));
+
+  //a frame with no edges links the same as the held state alone
+  uint64_t chain = digest.current().chain;
+  Test::step(input, timeNS);
+  InputFrame frame;
+  input.captureFrame(frame);
+  CHECK(digest.current().edges == 0);
+  CHECK(digest.current().chain == InputDigest::link(chain, frame.frameNumber, InputDigest::of(frame), 0));
+}
@@ -0,0 +1,57 @@
+#include "ns_Test.h"
+#include "cl_InputLayers.h"
+
+namespace {
+  bool hasBit(const Input::ButtonWords& words, size_t bit) { return (words[bit / 64] >> (bit % 64)) & 1; }
+}
+
+TEST_CASE(layerWordsHideConsumedButtons) {
+  Input input;
+  InputLayers layers(input);
+  uint64_t timeNS = Test::START_TIME_NS;
+  InputLayers::LayerID menu = layers.push();
+
+  Test::pressKey(input, 'A');
+  Test::pressKey(input, 'B');
+  Test::step(input, timeNS);
+  layers.consumeButton(menu, Input::DeviceType::KEYBOARD, 'A');
+
+  size_t a = Input::controlBit(Input::DeviceType::KEYBOARD, 'A');
+  size_t b = Input::controlBit(Input::DeviceType::KEYBOARD, 'B');
+  Input::ButtonWords held = layers.held(0, Input::DeviceType::KEYBOARD);
+  Input::ButtonWords triggered = layers.triggered(0, Input::DeviceType::KEYBOARD);
+  CHECK(!hasBit(held, a) && hasBit(held, b));
+  CHECK(!hasBit(triggered, a) && hasBit(triggered, b));
+  CHECK(hasBit(layers.held(menu, Input::DeviceType::KEYBOARD), a));
+
+  //another device's words never have keyboard bits
+  CHECK(!hasBit(layers.held(menu, Input::DeviceType::GAMEPAD), b));
+
+  //the consumption and the trigger edges end with the frame
+  Test::step(input, timeNS);
+  CHECK(hasBit(layers.held(0, Input::DeviceType::KEYBOARD), a));
+  CHECK(!hasBit(layers.triggered(0, Input::DeviceType::KEYBOARD), a));
+
+  Test::releaseKey(input, 'A');
+  Test::step(input, timeNS);
+  CHECK(!hasBit(input.heldWords(), a) && hasBit(input.heldWords(), b));
+}
+
+TEST_CASE(layersOffTheStackAreRejected) {
+  Input input;
+  InputLayers layers(input);
+
+  //never pushed, including IDs past the end of the stack's storage
+  CHECK_THROWS(layers.consumeButton(1, Input::DeviceType::KEYBOARD, 'A'));
+  CHECK_THROWS(layers.consumeAxis(InputLayers::MAX_LAYERS, Input::DeviceType::MOUSE, Input::Mouse::DELTA_X));
+  CHECK_THROWS(layers.held(InputLayers::MAX_LAYERS + 4, Input::DeviceType::KEYBOARD));
+
+  //popped - its masks are stale, so neither consuming on it nor reading through it is allowed
+  InputLayers::LayerID menu = layers.push();
+  layers.consumeButton(menu, Input::DeviceType::KEYBOARD, 'A');
+  layers.pop();
+  CHECK_THROWS(layers.consumeButton(menu, Input::DeviceType::KEYBOARD, 'B'));
+  CHECK_THROWS(layers.consumeAll(menu));
+  CHECK_THROWS(layers.visible(menu, Input::DeviceType::KEYBOARD, 'A'));
+  CHECK(layers.top() == 0);
+}
@@ -0,0 +1,15 @@
+#include "ns_Test.h"
+#include "cl_InputLoadGenerator.h"
+
+TEST_CASE(loadGeneratorAcceptsDevicesWithNoEventsYet) {
+  Input input;
+  InputLoadGenerator::Config config;
+  //with one event a frame, most of the simulated devices go several frames without an event
+  config.eventsPerFrame = 1;
+  config.keyboardCount = 4;
+  config.mouseCount = 4;
+  InputLoadGenerator generator(input, config);
+
+  for(int i = 0; i < 50; i++) { generator.runFrame(); }
+  CHECK(generator.report().divergences == 0);
+}
@@ -0,0 +1,124 @@
+#include "ns_Test.h"
+
+TEST_CASE(repeatCountsEveryPeriodInALongFrame) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  input.setRepeatDelayMS(100);
+  input.setRepeatPeriodMS(10);
+
+  Test::pressKey(input, 'A');
+  Test::step(input, timeNS);
+  CHECK(input.keyboard().buttons['A'].triggered && input.keyboard().buttons['A'].repeatCount == 1);
+
+  //100ms of delay and then 50ms of repeats, all in one frame
+  Test::step(input, timeNS, 150);
+  CHECK(input.keyboard().buttons['A'].repeating && input.keyboard().buttons['A'].repeatCount == 5);
+}
+
+TEST_CASE(lengtheningThePeriodMidHoldDoesNotBurst) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  input.setRepeatDelayMS(100);
+  input.setRepeatPeriodMS(10);
+
+  Test::pressKey(input, 'A');
+  Test::step(input, timeNS);
+  unsigned int repeats = 0;
+  for(int i = 0; i < 50; i++) {
+    Test::step(input, timeNS);
+    repeats += input.keyboard().buttons['A'].repeatCount;
+  }
+  CHECK(repeats > 30);
+
+  //with a 10x longer period the repeats already fired are ahead of schedule, which must not wrap around
+  input.setRepeatPeriodMS(100);
+  repeats = 0;
+  for(int i = 0; i < 100; i++) {
+    Test::step(input, timeNS);
+    auto& btn = input.keyboard().buttons['A'];
+    CHECK(btn.held && btn.repeatCount <= 1);
+    repeats += btn.repeatCount;
+  }
+  CHECK(repeats <= 10);
+}
+
+TEST_CASE(lengtheningTheDelayMidHoldDoesNotBurst) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  input.setRepeatDelayMS(50);
+  input.setRepeatPeriodMS(10);
+
+  Test::pressKey(input, 'A');
+  Test::stepFrames(input, timeNS, 20);
+
+  //the target falls behind the repeats already fired once the new delay has passed, too
+  input.setRepeatDelayMS(300);
+  for(int i = 0; i < 50; i++) {
+    Test::step(input, timeNS);
+    CHECK(input.keyboard().buttons['A'].repeatCount <= 1);
+  }
+}
+
+TEST_CASE(editingAProfileRestartsHeldButtons) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  input.setRepeatDelayMS(100);
+  input.setRepeatPeriodMS(10);
+
+  Test::pressKey(input, 'A');
+  Test::stepFrames(input, timeNS, 30);
+  CHECK(input.keyboard().buttons['A'].repeating);
+
+  //a shorter period would otherwise fire a burst right away, since the button has been held for 300ms
+  input.setRepeatPeriodMS(5);
+  for(int i = 0; i < 9; i++) {
+    Test::step(input, timeNS);
+    CHECK(!input.keyboard().buttons['A'].repeating);
+  }
+  Test::step(input, timeNS);
+  Test::step(input, timeNS);
+  CHECK(input.keyboard().buttons['A'].repeatCount == 2);
+}
+
+TEST_CASE(assigningAProfileRestartsHeldButtons) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  Input::RepeatProfileID fast = input.addRepeatProfile(50, 10);
+
+  Test::pressKey(input, 'A');
+  Test::stepFrames(input, timeNS, 100);
+
+  input.setRepeatProfile(Input::DeviceType::KEYBOARD, 'A', fast);
+  for(int i = 0; i < 4; i++) {
+    Test::step(input, timeNS);
+    CHECK(!input.keyboard().buttons['A'].repeating);
+  }
+  for(int i = 0; i < 10; i++) {
+    Test::step(input, timeNS);
+    CHECK(input.keyboard().buttons['A'].repeatCount <= 1);
+  }
+}
+
+TEST_CASE(reloadingOnlyRestartsRetimedProfiles) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+  input.setConfig(Test::parseConfig("repeat 100 10\n"));
+
+  Test::pressKey(input, 'A');
+  Test::stepFrames(input, timeNS, 30);
+  CHECK(input.keyboard().buttons['A'].repeating);
+
+  //the same timings under a new dead zone leave the repeats running
+  input.setConfig(Test::parseConfig("repeat 100 10\ndeadzone LEFT_X 0.2\n"));
+  Test::step(input, timeNS);
+  CHECK(input.keyboard().buttons['A'].repeatCount == 1);
+
+  //a new period starts the delay over
+  input.setConfig(Test::parseConfig("repeat 100 20\ndeadzone LEFT_X 0.2\n"));
+  for(int i = 0; i < 11; i++) {
+    Test::step(input, timeNS);
+    CHECK(!input.keyboard().buttons['A'].repeating);
+  }
+  Test::step(input, timeNS);
+  CHECK(input.keyboard().buttons['A'].repeatCount == 1);
+}
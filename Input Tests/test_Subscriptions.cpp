@@ -0,0 +1,28 @@
+#include "ns_Test.h"
+
+TEST_CASE(throwingCallbackStillEndsDispatch) {
+  Input input;
+  uint64_t timeNS = Test::START_TIME_NS;
+
+  int lateCalls = 0;
+  int victimCalls = 0;
+  Input::SubscriptionID victim = input.subscribe(Input::DeviceType::KEYBOARD, 'B', Input::ButtonEvent::TRIGGERED, [&](const Input::DeviceButton&) { victimCalls++; });
+  input.subscribe(Input::DeviceType::KEYBOARD, 'A', Input::ButtonEvent::TRIGGERED, [&](const Input::DeviceButton&) {
+    input.unsubscribe(victim);
+    input.subscribe(Input::DeviceType::KEYBOARD, 'B', Input::ButtonEvent::TRIGGERED, [&](const Input::DeviceButton&) { lateCalls++; });
+    throw std::runtime_error("callback failed");
+  });
+
+  Test::pressKey(input, 'A');
+  bool threw = false;
+  try { Test::step(input, timeNS); }
+  catch(const std::runtime_error&) { threw = true; }
+  CHECK(threw);
+
+  //the changes made before the throw are in place, and subscribing right away works again
+  int frameCalls = 0;
+  input.subscribeFrame([&]() { frameCalls++; });
+  Test::pressKey(input, 'B');
+  Test::step(input, timeNS);
+  CHECK(victimCalls == 0 && lateCalls == 1 && frameCalls == 1);
+}
@@ -0,0 +1,51 @@
+#include "ns_Test.h"
+#include "cl_VirtualControllers.h"
+#include "ns_Utility.h"
+
+TEST_CASE(virtualRepeatsMatchInput) {
+  Input input;
+  VirtualControllers controllers(1);
+  input.setRepeatDelayMS(100);
+  input.setRepeatPeriodMS(10);
+  controllers.setRepeat(100, 10);
+
+  Test::pressKey(input, 'A');
+  controllers.press(0, Input::Gamepad::A);
+
+  //uneven frames, including ones that span several periods
+  uint64_t timeNS = Test::START_TIME_NS;
+  const unsigned int frameMS[] = { 10, 40, 30, 25, 7, 3, 55, 16, 16, 16, 100, 1, 9 };
+  for(unsigned int ms : frameMS) {
+    Test::step(input, timeNS, ms);
+    controllers.update(timeNS);
+    auto& key = input.keyboard().buttons['A'];
+    Input::DeviceButton pad = controllers.button(0, Input::Gamepad::A);
+    CHECK(key.repeating == pad.repeating);
+    CHECK(key.repeatCount == pad.repeatCount);
+  }
+}
+
+TEST_CASE(virtualRetimingRestartsHeldButtons) {
+  VirtualControllers controllers(1);
+  uint64_t timeNS = Test::START_TIME_NS;
+  controllers.setRepeat(100, 10);
+
+  controllers.press(0, Input::Gamepad::A);
+  for(int i = 0; i < 30; i++) {
+    timeNS += Test::FRAME_MS * Utility::NS_PER_MS;
+    controllers.update(timeNS);
+  }
+  CHECK(controllers.button(0, Input::Gamepad::A).repeating);
+
+  //a longer period would otherwise leave the button behind the repeats already fired, and a shorter one
+  //would fire a burst
+  controllers.setRepeat(50, 5);
+  for(int i = 0; i < 5; i++) {
+    timeNS += Test::FRAME_MS * Utility::NS_PER_MS;
+    controllers.update(timeNS);
+    CHECK(!controllers.button(0, Input::Gamepad::A).repeating);
+  }
+  timeNS += Test::FRAME_MS * Utility::NS_PER_MS;
+  controllers.update(timeNS);
+  CHECK(controllers.button(0, Input::Gamepad::A).repeatCount == 2);
+}